@@ -181,7 +181,7 @@ class _TranslateScreenState extends State<TranslateScreen> {
     });
 
     try {
-      final result = await _translationService.translate(
+      final result = await _translationService.translateEdited(
         _fromLanguage,
         _toLanguage,
         text,
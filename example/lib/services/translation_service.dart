@@ -29,6 +29,8 @@ class TranslationService {
   final _loadedModels = <String>{};
   // 缓存生成的 YAML，避免重复 I/O + 字符串拼接
   final _configCache = <String, String>{};
+  // 增量翻译会话，按模型键缓存
+  final _sessions = <String, int>{};
 
   TranslationService._() {
     // 初始化翻译服务
@@ -134,6 +136,52 @@ class TranslationService {
     }
   }
 
+  /// 翻译正在编辑的文本
+  ///
+  /// 与 [translate] 不同，同一语言对的连续调用共用一个增量会话，
+  /// 只有改动过的句子会重新翻译。
+  Future<TranslationResult> translateEdited(
+    Language from,
+    Language to,
+    String text,
+  ) async {
+    try {
+      if (from == to) {
+        return TranslationResult.success(text);
+      }
+
+      if (text.trim().isEmpty) {
+        return TranslationResult.success('');
+      }
+
+      final translationPairs = ModelManager.getTranslationPairs(from, to);
+
+      // 预加载模型
+      await preloadModel(from, to);
+
+      final session = await _sessionFor(translationPairs);
+      final result = await bergamot.BergamotTranslator.updateSessionAsync(session, text);
+      return TranslationResult.success(result);
+    } catch (e) {
+      error('Translation failed: $e');
+      return TranslationResult.error('Translation failed: ${e.toString()}');
+    }
+  }
+
+  Future<int> _sessionFor(List<(Language, Language)> pairs) async {
+    final key = '${pairs[0].$1.code}${pairs[0].$2.code}';
+    final pivotKey = pairs.length == 2 ? '${pairs[1].$1.code}${pairs[1].$2.code}' : null;
+    final id = pivotKey == null ? key : '$key|$pivotKey';
+
+    final existing = _sessions[id];
+    if (existing != null) {
+      return existing;
+    }
+    final session = await bergamot.BergamotTranslator.createSessionAsync(key, pivotKey: pivotKey);
+    _sessions[id] = session;
+    return session;
+  }
+
   /// 批量翻译
   Future<TranslationResult> translateMultiple(
     Language from,
@@ -203,6 +251,8 @@ class TranslationService {
 
   /// 清理资源
   static Future<void> cleanup() async {
+    // 原生端清理时会话一并销毁
+    _instance?._sessions.clear();
     await bergamot.BergamotTranslator.cleanupAsync();
   }
 }
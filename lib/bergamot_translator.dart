@@ -2,6 +2,8 @@ import 'dart:ffi' as ffi;
 import 'dart:io';
 import 'dart:isolate';
 import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
@@ -55,9 +57,220 @@ class DetectionResult {
       'DetectionResult(language: $language, isReliable: $isReliable, confidence: $confidence)';
 }
 
+/// CPU 特性与矩阵乘法路径
+class CpuInfo {
+  /// 实际使用的 int8 矩阵乘法路径（如 "intgemm-avx2", "ruy-neon"）
+  final String gemmPath;
+
+  final bool hasSsse3;
+  final bool hasSse41;
+  final bool hasAvx2;
+  final bool hasAvx512bw;
+  final bool hasAvx512vnni;
+  final bool hasNeon;
+
+  CpuInfo({
+    required this.gemmPath,
+    required this.hasSsse3,
+    required this.hasSse41,
+    required this.hasAvx2,
+    required this.hasAvx512bw,
+    required this.hasAvx512vnni,
+    required this.hasNeon,
+  });
+
+  @override
+  String toString() =>
+      'CpuInfo(gemmPath: $gemmPath, ssse3: $hasSsse3, sse41: $hasSse41, avx2: $hasAvx2, '
+      'avx512bw: $hasAvx512bw, avx512vnni: $hasAvx512vnni, neon: $hasNeon)';
+}
+
+/// 结果缓存统计
+class CacheStats {
+  final int hits;
+  final int misses;
+  final int entries;
+  final int capacity;
+
+  CacheStats({
+    required this.hits,
+    required this.misses,
+    required this.entries,
+    required this.capacity,
+  });
+
+  /// 命中率（0-1），尚无查询时为 0
+  double get hitRate => hits + misses == 0 ? 0 : hits / (hits + misses);
+
+  @override
+  String toString() =>
+      'CacheStats(hits: $hits, misses: $misses, entries: $entries, capacity: $capacity)';
+}
+
+/// 相同请求合并统计
+class CoalescingStats {
+  /// 实际交给解码器的输入数
+  final int decoded;
+
+  /// 合并到正在进行的相同解码、未重复解码的输入数
+  final int coalesced;
+
+  /// 当前正在解码的不同输入数
+  final int pending;
+
+  CoalescingStats({
+    required this.decoded,
+    required this.coalesced,
+    required this.pending,
+  });
+
+  @override
+  String toString() =>
+      'CoalescingStats(decoded: $decoded, coalesced: $coalesced, pending: $pending)';
+}
+
+/// 单个模型的内存占用（字节）
+///
+/// 线程池模式下为所有服务副本之和。
+class ModelMemory {
+  /// 模型缓存键
+  final String key;
+
+  /// 权重
+  final int modelBytes;
+
+  /// 词表（与其他模型共享的词表在每个模型中都计入）
+  final int vocabBytes;
+
+  /// 词表短名单
+  final int shortlistBytes;
+
+  /// 断句前缀文件、质量估计模型
+  final int otherBytes;
+
+  /// 解码工作区：每个工作线程按配置的 workspace 各预留一份
+  final int workspaceBytes;
+
+  /// 持有该模型工作区的工作线程数
+  final int workers;
+
+  ModelMemory({
+    required this.key,
+    required this.modelBytes,
+    required this.vocabBytes,
+    required this.shortlistBytes,
+    required this.otherBytes,
+    required this.workspaceBytes,
+    required this.workers,
+  });
+
+  /// 该模型各项之和
+  int get totalBytes => modelBytes + vocabBytes + shortlistBytes + otherBytes + workspaceBytes;
+
+  @override
+  String toString() =>
+      'ModelMemory($key, model: $modelBytes, vocab: $vocabBytes, shortlist: $shortlistBytes, '
+      'other: $otherBytes, workspace: $workspaceBytes, workers: $workers)';
+}
+
+/// 内存统计
+class MemoryStats {
+  /// 已加载模型，按键排序
+  final List<ModelMemory> models;
+
+  /// 去重后的词表总量
+  final int vocabBytes;
+
+  /// 结果缓存占用（估算）
+  final int resultCacheBytes;
+
+  final int resultCacheEntries;
+
+  /// 库内可统计部分之和（词表按去重计）
+  final int trackedBytes;
+
+  /// 进程常驻内存，平台不支持时为 null
+  final int? processResidentBytes;
+
+  /// 进程常驻内存峰值，平台不支持时为 null
+  final int? processPeakResidentBytes;
+
+  MemoryStats({
+    required this.models,
+    required this.vocabBytes,
+    required this.resultCacheBytes,
+    required this.resultCacheEntries,
+    required this.trackedBytes,
+    required this.processResidentBytes,
+    required this.processPeakResidentBytes,
+  });
+
+  @override
+  String toString() =>
+      'MemoryStats(models: $models, vocab: $vocabBytes, resultCache: $resultCacheBytes, '
+      'tracked: $trackedBytes, resident: $processResidentBytes, peak: $processPeakResidentBytes)';
+}
+
+/// 结构化翻译结果
+///
+/// 与 C 接口相同，按输入、句子顺序平铺为扁平数组，避免逐句创建对象。
+/// 字节区间为 [begin, end) 对，相对于对应输入的原文或译文（UTF-8）；词下标在句内编号。
+/// 未请求的部分为 null。
+class TranslationDetails {
+  /// 译文，顺序与输入对应
+  final List<String> targets;
+
+  /// 第 i 条输入的句子为 [inputSentences[i], inputSentences[i+1])
+  final Int32List inputSentences;
+
+  /// 句子映射（[sentenceMappings]）：每句两个值
+  final Int32List? sourceSentenceSpans;
+  final Int32List? targetSentenceSpans;
+
+  /// 质量分数（[qualityScores]）
+  final Float32List? sentenceScores;
+  final Int32List? sentenceWordScores;
+  final Float32List? wordScores;
+  final Int32List? wordScoreSpans;
+
+  /// 对齐（[alignment]）
+  final Int32List? sentenceSourceWords;
+  final Int32List? sourceWordSpans;
+  final Int32List? sentenceTargetWords;
+  final Int32List? targetWordSpans;
+  final Int32List? sentenceAlignments;
+
+  /// 每个对齐点两个值：(目标词下标, 源词下标)
+  final Int32List? alignmentPoints;
+  final Float32List? alignmentProbs;
+
+  TranslationDetails({
+    required this.targets,
+    required this.inputSentences,
+    this.sourceSentenceSpans,
+    this.targetSentenceSpans,
+    this.sentenceScores,
+    this.sentenceWordScores,
+    this.wordScores,
+    this.wordScoreSpans,
+    this.sentenceSourceWords,
+    this.sourceWordSpans,
+    this.sentenceTargetWords,
+    this.targetWordSpans,
+    this.sentenceAlignments,
+    this.alignmentPoints,
+    this.alignmentProbs,
+  });
+
+  int get sentenceCount => inputSentences.last;
+}
+
 /// 内部：后台 Isolate 调度器
 ///
 /// 目的：将同步 FFI 调用移出 UI isolate，避免掉帧/卡顿，并降低 debug 模式下的体感延迟。
+/// 可配置多个 worker isolate（[BergamotTranslator.setWorkerIsolates]）：带模型键的请求按键固定分配到
+/// 同一 worker，同一模型的请求保持提交顺序，不同模型的请求并行进入原生层；
+/// 初始化、服务配置与清理固定在 0 号 worker 上执行。
 class _BergamotBackground {
   static _BergamotBackground? _instance;
 
@@ -68,32 +281,40 @@ class _BergamotBackground {
 
   _BergamotBackground._();
 
-  Isolate? _isolate;
-  SendPort? _sendPort;
+  /// 下次启动时的 worker 数量
+  static int workerCount = 1;
+
+  final List<Isolate> _isolates = [];
+  List<SendPort>? _sendPorts;
   ReceivePort? _receivePort;
   StreamSubscription<dynamic>? _receiveSub;
   Future<void>? _starting;
 
   int _nextId = 1;
+  int _nextWorker = 0;
   final Map<int, Completer<Object?>> _pending = {};
 
+  /// [restartWhenIdle] 等待未完成请求时非空；期间新请求等它完成后按新数量重新启动
+  Completer<void>? _draining;
+
   Future<void> _ensureStarted() async {
-    if (_sendPort != null) return;
+    if (_sendPorts != null) return;
     if (_starting != null) {
       await _starting!;
       return;
     }
 
-    final handshake = Completer<SendPort>();
+    final count = workerCount;
+    final handshakes = List.generate(count, (_) => Completer<SendPort>());
     _starting = () async {
       _receivePort ??= ReceivePort();
 
-      // 监听来自 worker isolate 的响应（含握手 sendPort）
+      // 监听来自 worker isolate 的响应（含握手 [index, sendPort]）
       _receiveSub ??= _receivePort!.listen((dynamic message) {
-        if (message is SendPort) {
-          _sendPort = message;
-          if (!handshake.isCompleted) {
-            handshake.complete(message);
+        if (message is List && message.length == 2 && message[0] is int && message[1] is SendPort) {
+          final index = message[0] as int;
+          if (index < handshakes.length && !handshakes[index].isCompleted) {
+            handshakes[index].complete(message[1] as SendPort);
           }
           return;
         }
@@ -112,16 +333,21 @@ class _BergamotBackground {
           final err = message['error']?.toString() ?? 'Unknown error';
           completer.completeError(BergamotException(err));
         }
+        if (_draining != null && _pending.isEmpty) {
+          shutdown();
+        }
       });
 
-      _isolate = await Isolate.spawn<_IsolateInit>(
-        _bergamotWorkerMain,
-        _IsolateInit(_receivePort!.sendPort),
-        debugName: 'bergamot_translator_worker',
-      );
+      for (int i = 0; i < count; i++) {
+        _isolates.add(await Isolate.spawn<_IsolateInit>(
+          _bergamotWorkerMain,
+          _IsolateInit(_receivePort!.sendPort, i),
+          debugName: 'bergamot_translator_worker_$i',
+        ));
+      }
 
       try {
-        _sendPort = await handshake.future
+        _sendPorts = await Future.wait(handshakes.map((h) => h.future))
             .timeout(const Duration(seconds: 5));
       } on TimeoutException {
         throw BergamotException('Failed to start bergamot worker isolate (timeout)');
@@ -135,14 +361,26 @@ class _BergamotBackground {
     }
   }
 
-  Future<T> _call<T>(String cmd, Map<String, Object?> payload) async {
+  /// [affinity] 为 null 时在 0 号 worker 上执行；否则按其哈希固定到某个 worker；
+  /// 空字符串表示不需要亲和性，轮流分配
+  SendPort _portFor(String? affinity) {
+    final ports = _sendPorts!;
+    if (ports.length == 1 || affinity == null) return ports.first;
+    if (affinity.isEmpty) return ports[_nextWorker++ % ports.length];
+    return ports[(affinity.hashCode & 0x7fffffff) % ports.length];
+  }
+
+  Future<T> _call<T>(String cmd, Map<String, Object?> payload, [String? affinity]) async {
+    while (_draining != null) {
+      await _draining!.future;
+    }
     await _ensureStarted();
 
     final id = _nextId++;
     final completer = Completer<Object?>();
     _pending[id] = completer;
 
-    _sendPort!.send(<String, Object?>{
+    _portFor(affinity).send(<String, Object?>{
       'id': id,
       'cmd': cmd,
       ...payload,
@@ -154,24 +392,140 @@ class _BergamotBackground {
 
   Future<void> initializeService() => _call<void>('init', const {});
 
+  Future<void> configureService(
+    int numWorkers,
+    int cacheSize,
+    String? cpuSet,
+    bool numaReplicas,
+    int preprocessThreads,
+  ) =>
+      _call<void>('configureService', <String, Object?>{
+        'numWorkers': numWorkers,
+        'cacheSize': cacheSize,
+        'cpuSet': cpuSet,
+        'numaReplicas': numaReplicas,
+        'preprocessThreads': preprocessThreads,
+      });
+
   Future<void> loadModel(String cfg, String key) =>
-      _call<void>('loadModel', <String, Object?>{'cfg': cfg, 'key': key});
+      _call<void>('loadModel', <String, Object?>{'cfg': cfg, 'key': key}, key);
+
+  Future<void> loadModelBundle(String path, String key) =>
+      _call<void>('loadModelBundle', <String, Object?>{'path': path, 'key': key}, key);
 
-  Future<List<String>> translateMultiple(List<String> inputs, String key) =>
-      _call<List<String>>('translateMultiple', <String, Object?>{'inputs': inputs, 'key': key});
+  Future<List<String>> translateMultiple(List<String> inputs, String key) async {
+    if (inputs.isEmpty) return [];
+    final packed = await _call<TransferableTypedData>(
+      'translatePacked',
+      <String, Object?>{'inputs': _packStrings(inputs), 'key': key, 'pivotKey': null},
+      key,
+    );
+    return _unpackStrings(packed, inputs.length);
+  }
 
-  Future<List<String>> pivotMultiple(List<String> inputs, String firstKey, String secondKey) =>
-      _call<List<String>>('pivotMultiple', <String, Object?>{
+  Future<TranslationDetails> translateDetailed(
+    List<String> inputs,
+    String key,
+    bool qualityScores,
+    bool alignment,
+    bool sentenceMappings,
+    bool html,
+    double alignmentThreshold,
+  ) =>
+      _call<TranslationDetails>('translateDetailed', <String, Object?>{
         'inputs': inputs,
-        'firstKey': firstKey,
-        'secondKey': secondKey,
-      });
+        'key': key,
+        'qualityScores': qualityScores,
+        'alignment': alignment,
+        'sentenceMappings': sentenceMappings,
+        'html': html,
+        'alignmentThreshold': alignmentThreshold,
+      }, key);
+
+  Future<void> translateFile(
+    String inPath,
+    String outPath,
+    String key,
+    int chunkBytes,
+    int maxInFlight,
+    bool html,
+    SendPort? progressPort,
+  ) =>
+      _call<void>('translateFile', <String, Object?>{
+        'inPath': inPath,
+        'outPath': outPath,
+        'key': key,
+        'chunkBytes': chunkBytes,
+        'maxInFlight': maxInFlight,
+        'html': html,
+        'progressPort': progressPort,
+      }, key);
+
+  Future<void> translateJsonl(
+    String inPath,
+    String outPath,
+    String key,
+    String field,
+    String? outputField,
+    int chunkBytes,
+    int maxInFlight,
+    bool html,
+    SendPort? progressPort,
+  ) =>
+      _call<void>('translateJsonl', <String, Object?>{
+        'inPath': inPath,
+        'outPath': outPath,
+        'key': key,
+        'field': field,
+        'outputField': outputField,
+        'chunkBytes': chunkBytes,
+        'maxInFlight': maxInFlight,
+        'html': html,
+        'progressPort': progressPort,
+      }, key);
+
+  Future<List<String>> pivotMultiple(List<String> inputs, String firstKey, String secondKey) async {
+    if (inputs.isEmpty) return [];
+    final packed = await _call<TransferableTypedData>(
+      'translatePacked',
+      <String, Object?>{'inputs': _packStrings(inputs), 'key': firstKey, 'pivotKey': secondKey},
+      '$firstKey|$secondKey',
+    );
+    return _unpackStrings(packed, inputs.length);
+  }
+
+  Future<List<List<String>>> pivotFanOut(List<String> inputs, String sourceKey, List<String> targetKeys) =>
+      _call<List<List<String>>>('pivotFanOut', <String, Object?>{
+        'inputs': inputs,
+        'sourceKey': sourceKey,
+        'targetKeys': targetKeys,
+      }, sourceKey);
 
   Future<Map<String, Object?>> detectLanguage(String text, String? hint) =>
-      _call<Map<String, Object?>>('detectLanguage', <String, Object?>{'text': text, 'hint': hint});
+      _call<Map<String, Object?>>('detectLanguage', <String, Object?>{'text': text, 'hint': hint}, '');
+
+  Future<int> createSession(String key, String? pivotKey) =>
+      _call<int>('createSession', <String, Object?>{'key': key, 'pivotKey': pivotKey}, '');
+
+  Future<String> updateSession(int session, String text) =>
+      _call<String>('updateSession', <String, Object?>{'session': session, 'text': text}, 'session:$session');
+
+  Future<void> closeSession(int session) =>
+      _call<void>('closeSession', <String, Object?>{'session': session}, 'session:$session');
+
+  Future<void> trimMemory() => _call<void>('trimMemory', const {});
 
   Future<void> cleanup() => _call<void>('cleanup', const {});
 
+  /// 未完成的请求全部返回后再关闭 isolate；没有未完成的请求时立即关闭
+  void restartWhenIdle() {
+    if (_pending.isEmpty) {
+      shutdown();
+      return;
+    }
+    _draining ??= Completer<void>();
+  }
+
   void shutdown() {
     // 让所有未完成的请求尽快失败，避免退出时 await 永久悬挂。
     if (_pending.isNotEmpty) {
@@ -184,25 +538,71 @@ class _BergamotBackground {
       _pending.clear();
     }
 
-    _isolate?.kill(priority: Isolate.immediate);
-    _isolate = null;
-    _sendPort = null;
+    for (final isolate in _isolates) {
+      isolate.kill(priority: Isolate.immediate);
+    }
+    _isolates.clear();
+    _sendPorts = null;
     _receiveSub?.cancel();
     _receiveSub = null;
     _receivePort?.close();
     _receivePort = null;
+
+    final draining = _draining;
+    _draining = null;
+    draining?.complete();
+  }
+}
+
+/// 把字符串列表编码为依次相连、各以 0 结尾的 UTF-8 缓冲区（bergamot_translate_packed 的格式），
+/// 整批作为一个 [TransferableTypedData] 在 isolate 间移交，不逐条复制字符串。
+/// 文本中的 U+0000 会被当作分隔符，使条数与顺序错位，因此拒绝含 U+0000 的输入而不是悄悄改写它
+TransferableTypedData _packStrings(List<String> strings) {
+  for (var i = 0; i < strings.length; i++) {
+    if (strings[i].contains('\u0000')) {
+      throw ArgumentError.value(strings[i], 'inputs[$i]', 'must not contain U+0000');
+    }
   }
+  final encoded = [for (final s in strings) utf8.encode(s)];
+  var total = 0;
+  for (final bytes in encoded) {
+    total += bytes.length + 1;
+  }
+  final buffer = Uint8List(total);
+  var offset = 0;
+  for (final bytes in encoded) {
+    buffer.setAll(offset, bytes);
+    offset += bytes.length + 1;
+  }
+  return TransferableTypedData.fromList([buffer]);
+}
+
+List<String> _unpackStrings(TransferableTypedData data, int expected) {
+  final bytes = data.materialize().asUint8List();
+  final strings = <String>[];
+  var begin = 0;
+  for (var i = 0; i < bytes.length; i++) {
+    if (bytes[i] == 0) {
+      strings.add(utf8.decode(Uint8List.sublistView(bytes, begin, i)));
+      begin = i + 1;
+    }
+  }
+  if (strings.length != expected || begin != bytes.length) {
+    throw BergamotException('Translation count does not match input');
+  }
+  return strings;
 }
 
 class _IsolateInit {
   final SendPort mainSendPort;
-  const _IsolateInit(this.mainSendPort);
+  final int index;
+  const _IsolateInit(this.mainSendPort, this.index);
 }
 
 void _bergamotWorkerMain(_IsolateInit init) {
   final mainSendPort = init.mainSendPort;
   final port = ReceivePort();
-  mainSendPort.send(port.sendPort);
+  mainSendPort.send(<Object>[init.index, port.sendPort]);
 
   // worker isolate 内部执行同步 FFI
   port.listen((dynamic raw) {
@@ -220,21 +620,82 @@ void _bergamotWorkerMain(_IsolateInit init) {
           BergamotTranslator.initializeService();
           mainSendPort.send(ok(null));
           return;
+        case 'configureService':
+          BergamotTranslator.configureService(
+            numWorkers: raw['numWorkers'] as int,
+            cacheSize: raw['cacheSize'] as int,
+            cpuSet: raw['cpuSet'] as String?,
+            numaReplicas: raw['numaReplicas'] as bool,
+            preprocessThreads: raw['preprocessThreads'] as int,
+          );
+          mainSendPort.send(ok(null));
+          return;
         case 'loadModel':
           BergamotTranslator.loadModel(raw['cfg'] as String, raw['key'] as String);
           mainSendPort.send(ok(null));
           return;
-        case 'translateMultiple':
-          final inputs = (raw['inputs'] as List).cast<String>();
-          final key = raw['key'] as String;
-          final out = BergamotTranslator.translateMultiple(inputs, key);
+        case 'loadModelBundle':
+          BergamotTranslator.loadModelBundle(raw['path'] as String, raw['key'] as String);
+          mainSendPort.send(ok(null));
+          return;
+        case 'translatePacked':
+          final inputs = (raw['inputs'] as TransferableTypedData).materialize().asUint8List();
+          final out = BergamotTranslator._translatePacked(
+            inputs,
+            raw['key'] as String,
+            raw['pivotKey'] as String?,
+          );
           mainSendPort.send(ok(out));
           return;
-        case 'pivotMultiple':
+        case 'translateDetailed':
+          final out = BergamotTranslator.translateDetailed(
+            (raw['inputs'] as List).cast<String>(),
+            raw['key'] as String,
+            qualityScores: raw['qualityScores'] as bool,
+            alignment: raw['alignment'] as bool,
+            sentenceMappings: raw['sentenceMappings'] as bool,
+            html: raw['html'] as bool,
+            alignmentThreshold: raw['alignmentThreshold'] as double,
+          );
+          mainSendPort.send(ok(out));
+          return;
+        case 'translateFile':
+          final progressPort = raw['progressPort'] as SendPort?;
+          BergamotTranslator.translateFile(
+            raw['inPath'] as String,
+            raw['outPath'] as String,
+            raw['key'] as String,
+            chunkBytes: raw['chunkBytes'] as int,
+            maxInFlight: raw['maxInFlight'] as int,
+            html: raw['html'] as bool,
+            onProgress: progressPort == null
+                ? null
+                : (done, total) => progressPort.send(<int>[done, total]),
+          );
+          mainSendPort.send(ok(null));
+          return;
+        case 'translateJsonl':
+          final progressPort = raw['progressPort'] as SendPort?;
+          BergamotTranslator.translateJsonl(
+            raw['inPath'] as String,
+            raw['outPath'] as String,
+            raw['key'] as String,
+            raw['field'] as String,
+            outputField: raw['outputField'] as String?,
+            chunkBytes: raw['chunkBytes'] as int,
+            maxInFlight: raw['maxInFlight'] as int,
+            html: raw['html'] as bool,
+            onProgress: progressPort == null
+                ? null
+                : (done, total) => progressPort.send(<int>[done, total]),
+          );
+          mainSendPort.send(ok(null));
+          return;
+        case 'pivotFanOut':
           final inputs = (raw['inputs'] as List).cast<String>();
-          final firstKey = raw['firstKey'] as String;
-          final secondKey = raw['secondKey'] as String;
-          final out = BergamotTranslator.pivotMultiple(inputs, firstKey, secondKey);
+          final sourceKey = raw['sourceKey'] as String;
+          final targetKeys = (raw['targetKeys'] as List).cast<String>();
+          final out = BergamotTranslator.pivotFanOut(inputs, sourceKey, targetKeys);
           mainSendPort.send(ok(out));
           return;
         case 'detectLanguage':
@@ -247,6 +708,25 @@ void _bergamotWorkerMain(_IsolateInit init) {
             'confidence': res.confidence,
           }));
           return;
+        case 'createSession':
+          final out = BergamotTranslator.createSession(
+            raw['key'] as String,
+            pivotKey: raw['pivotKey'] as String?,
+          );
+          mainSendPort.send(ok(out));
+          return;
+        case 'updateSession':
+          final out = BergamotTranslator.updateSession(raw['session'] as int, raw['text'] as String);
+          mainSendPort.send(ok(out));
+          return;
+        case 'closeSession':
+          BergamotTranslator.closeSession(raw['session'] as int);
+          mainSendPort.send(ok(null));
+          return;
+        case 'trimMemory':
+          BergamotTranslator.trimMemory();
+          mainSendPort.send(ok(null));
+          return;
         case 'cleanup':
           BergamotTranslator.cleanup();
           mainSendPort.send(ok(null));
@@ -311,6 +791,67 @@ class BergamotTranslator {
     return _BergamotBackground.instance.initializeService();
   }
 
+  /// 配置翻译服务
+  ///
+  /// [numWorkers] 工作线程总数；0（默认）表示在调用线程上同步翻译，多个调用方串行执行。
+  /// 大于 0 时由线程池并发解码，多个 isolate 的请求可以同时进行。
+  /// [cacheSize] 翻译缓存条目数，0 表示禁用。
+  /// [cpuSet] 工作线程允许运行的 CPU 列表（如 "0-7,16-23"），仅 Linux/Android 生效。
+  /// [numaReplicas] 为 true 时每个 NUMA 节点一个服务及模型副本，工作线程绑定到本节点，
+  /// 请求路由到调用线程所在节点的副本；[numWorkers] 在各节点间平分。
+  /// [preprocessThreads] 断句与子词编码线程数（需 [numWorkers] > 0）。大于 0 时调用线程只负责提交，
+  /// 预处理在这些线程上与解码重叠进行；0 表示在调用线程上处理。
+  ///
+  /// 必须在加载任何模型之前调用。
+  ///
+  /// 抛出 [BergamotException] 如果配置无效或已有模型加载。
+  static void configureService({
+    int numWorkers = 0,
+    int cacheSize = 256,
+    String? cpuSet,
+    bool numaReplicas = false,
+    int preprocessThreads = 0,
+  }) {
+    _ensureInitialized();
+    final config = calloc<BergamotServiceConfig>();
+    final cpuSetPtr = cpuSet?.toNativeUtf8();
+    try {
+      config.ref.num_workers = numWorkers;
+      config.ref.cache_size = cacheSize;
+      config.ref.cpu_set = cpuSetPtr?.cast<ffi.Char>() ?? ffi.Pointer<ffi.Char>.fromAddress(0);
+      config.ref.numa_replicas = numaReplicas ? 1 : 0;
+      config.ref.preprocess_threads = preprocessThreads;
+      final result = _bindings!.bergamot_configure_service(config);
+      if (result != 0) {
+        throw BergamotException('Failed to configure service', result);
+      }
+    } finally {
+      if (cpuSetPtr != null) {
+        malloc.free(cpuSetPtr);
+      }
+      calloc.free(config);
+    }
+  }
+
+  /// 配置翻译服务（后台 Isolate 版本）
+  ///
+  /// 在 0 号后台 isolate 中执行，参数见 [configureService]。
+  static Future<void> configureServiceAsync({
+    int numWorkers = 0,
+    int cacheSize = 256,
+    String? cpuSet,
+    bool numaReplicas = false,
+    int preprocessThreads = 0,
+  }) {
+    return _BergamotBackground.instance.configureService(
+      numWorkers,
+      cacheSize,
+      cpuSet,
+      numaReplicas,
+      preprocessThreads,
+    );
+  }
+
   /// 加载模型到缓存
   ///
   /// [cfg] 模型配置字符串（YAML格式）
@@ -354,118 +895,836 @@ class BergamotTranslator {
     return _BergamotBackground.instance.loadModel(cfg, key);
   }
 
-  /// 批量翻译
+  /// 从单文件模型包加载模型到缓存
   ///
-  /// [inputs] 要翻译的文本列表
-  /// [key] 模型缓存键（必须已通过 [loadModel] 加载）
+  /// [path] 模型包路径（.bgtb，由 bergamot-bundle 工具生成）
+  /// [key] 模型缓存键，用于后续翻译时引用此模型
   ///
-  /// 返回翻译结果列表，顺序与输入列表对应。
+  /// 与 [loadModel] 相比，映射整个文件读取各段，不再逐个打开文件和解析 YAML 配置。
   ///
-  /// 抛出 [BergamotException] 如果翻译失败。
-  static List<String> translateMultiple(List<String> inputs, String key) {
-    if (inputs.isEmpty) {
-      return [];
-    }
-
+  /// 抛出 [BergamotException] 如果加载失败。
+  static void loadModelBundle(String path, String key) {
     _ensureInitialized();
-
-    // 分配输入字符串数组
-    final inputPtrs = inputs
-        .map((s) => s.toNativeUtf8().cast<ffi.Char>())
-        .toList();
-    final inputsArray = malloc.allocate<ffi.Pointer<ffi.Char>>(
-      ffi.sizeOf<ffi.Pointer<ffi.Char>>() * inputs.length,
-    );
-
-    for (int i = 0; i < inputs.length; i++) {
-      inputsArray[i] = inputPtrs[i];
+    final pathPtr = path.toNativeUtf8();
+    final keyPtr = key.toNativeUtf8();
+    try {
+      final result = _bindings!.bergamot_load_model_bundle(
+        pathPtr.cast<ffi.Char>(),
+        keyPtr.cast<ffi.Char>(),
+      );
+      if (result != 0) {
+        throw BergamotException(
+          'Failed to load model bundle: $key ($path). '
+          'Please check the file exists and was built by a matching bergamot-bundle version.',
+          result,
+        );
+      }
+    } finally {
+      malloc.free(pathPtr);
+      malloc.free(keyPtr);
     }
+  }
 
-    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
-    final outputsPtr = malloc.allocate<ffi.Pointer<ffi.Pointer<ffi.Char>>>(
-      ffi.sizeOf<ffi.Pointer<ffi.Pointer<ffi.Char>>>(),
-    );
-    final outputCountPtr = malloc<ffi.Int32>(ffi.sizeOf<ffi.Int32>());
+  /// 从模型包加载模型（后台 Isolate 版本）
+  ///
+  /// 推荐在 Flutter 场景使用：避免同步 FFI 阻塞 UI isolate。
+  static Future<void> loadModelBundleAsync(String path, String key) {
+    return _BergamotBackground.instance.loadModelBundle(path, key);
+  }
 
+  /// 替换已加载的模型，不中断翻译
+  ///
+  /// 用于把 [key] 下的模型更新到新版本：新模型构造期间请求照常使用旧模型，构造完成后原子换入，
+  /// 之后的请求使用新模型；进行中的请求在旧模型上完成，旧模型在最后一个请求结束时释放。
+  /// [key] 不存在时等同于 [loadModel]。构造失败时旧模型保持不变，并抛出 [BergamotException]。
+  ///
+  /// 构造新模型需要数秒，期间调用线程被占用；Flutter 场景使用 [replaceModelAsync]。
+  static void replaceModel(String cfg, String key) {
+    _ensureInitialized();
+    final cfgPtr = cfg.toNativeUtf8();
+    final keyPtr = key.toNativeUtf8();
     try {
-      final result = _bindings!.bergamot_translate_multiple(
-        inputsArray,
-        inputs.length,
-        keyPtr,
-        outputsPtr,
-        outputCountPtr.cast(),
+      final result = _bindings!.bergamot_replace_model(
+        cfgPtr.cast<ffi.Char>(),
+        keyPtr.cast<ffi.Char>(),
       );
-
       if (result != 0) {
-        throw BergamotException('Failed to translate', result);
+        throw BergamotException('Failed to replace model: $key', result);
       }
+    } finally {
+      malloc.free(cfgPtr);
+      malloc.free(keyPtr);
+    }
+  }
 
-      final outputCount = outputCountPtr[0];
-      final outputsArray = outputsPtr.value;
+  /// 替换已加载的模型（独立 Isolate 版本）
+  ///
+  /// 在一个临时 isolate 中构造新模型，不占用执行翻译的后台 isolate，
+  /// 因此替换期间 `...Async` 翻译请求照常进行。
+  static Future<void> replaceModelAsync(String cfg, String key) {
+    return Isolate.run(() => replaceModel(cfg, key), debugName: 'bergamot_replace_model');
+  }
 
-      final translations = <String>[];
-      for (int i = 0; i < outputCount; i++) {
-        final strPtr = outputsArray[i];
-        translations.add(strPtr.cast<Utf8>().toDartString());
+  /// 以模型包替换已加载的模型，行为与 [replaceModel] 相同
+  static void replaceModelBundle(String path, String key) {
+    _ensureInitialized();
+    final pathPtr = path.toNativeUtf8();
+    final keyPtr = key.toNativeUtf8();
+    try {
+      final result = _bindings!.bergamot_replace_model_bundle(
+        pathPtr.cast<ffi.Char>(),
+        keyPtr.cast<ffi.Char>(),
+      );
+      if (result != 0) {
+        throw BergamotException('Failed to replace model bundle: $key ($path)', result);
       }
-
-      // 释放 C 分配的内存
-      _bindings!.bergamot_free_string_array(outputsArray, outputCount);
-
-      return translations;
     } finally {
-      // 释放输入字符串
-      for (final ptr in inputPtrs) {
-        malloc.free(ptr);
-      }
-      malloc.free(inputsArray);
+      malloc.free(pathPtr);
       malloc.free(keyPtr);
-      malloc.free(outputsPtr);
-      malloc.free(outputCountPtr);
     }
   }
 
-  /// 批量翻译（后台 Isolate 版本）
-  ///
-  /// 推荐在 Flutter 场景使用：避免同步 FFI 阻塞 UI isolate。
-  static Future<List<String>> translateMultipleAsync(List<String> inputs, String key) {
-    return _BergamotBackground.instance.translateMultiple(inputs, key);
+  /// 以模型包替换已加载的模型（独立 Isolate 版本），见 [replaceModelAsync]
+  static Future<void> replaceModelBundleAsync(String path, String key) {
+    return Isolate.run(() => replaceModelBundle(path, key), debugName: 'bergamot_replace_model');
   }
 
-  /// 翻译单个文本
+  /// 设置预处理权重缓存（默认关闭）
   ///
-  /// [input] 要翻译的文本
-  /// [key] 模型缓存键（必须已通过 [loadModel] 加载）
+  /// 启用后，首次加载 intgemm 模型时会把按当前 CPU 指令集重排好的权重写入缓存文件，
+  /// 之后的加载直接使用缓存，跳过加载期的权重重排，缩短冷启动时间。
   ///
-  /// 返回翻译结果。
+  /// [cacheDir] 缓存目录；为 null 时写在模型文件旁边（模型目录只读时需指定）。
   ///
-  /// 抛出 [BergamotException] 如果翻译失败。
-  static String translate(String input, String key) {
-    final results = translateMultiple([input], key);
-    if (results.isEmpty) {
-      throw BergamotException('Translation returned empty result');
+  /// 只影响之后加载的模型。缓存设置在整个进程内共享，可在任意 isolate 调用。
+  static void setWeightCache(bool enabled, [String? cacheDir]) {
+    _ensureInitialized();
+    final dirPtr = cacheDir?.toNativeUtf8();
+    try {
+      final result = _bindings!.bergamot_set_weight_cache(
+        enabled ? 1 : 0,
+        dirPtr?.cast<ffi.Char>() ?? ffi.Pointer<ffi.Char>.fromAddress(0),
+      );
+      if (result != 0) {
+        throw BergamotException('Failed to configure weight cache', result);
+      }
+    } finally {
+      if (dirPtr != null) {
+        malloc.free(dirPtr);
+      }
     }
-    return results.first;
   }
 
-  /// 枢轴翻译（通过中间语言）
+  /// 设置输入文本级结果缓存
   ///
-  /// [inputs] 要翻译的文本列表
-  /// [firstKey] 第一个模型缓存键（源语言 -> 中间语言）
-  /// [secondKey] 第二个模型缓存键（中间语言 -> 目标语言）
+  /// [capacity] 条目数，0 关闭并清空（默认关闭）。
   ///
-  /// 返回翻译结果列表，顺序与输入列表对应。
+  /// 以 (模型内容, 输入文本) 为键，命中时完全跳过断句、子词编码与解码。
+  /// 与 bergamot 自带的句子缓存不同，它由所有服务副本共享，同一模型重新加载后仍然有效。
+  /// HTML 与结构化结果（[translateDetailed]）不经过此缓存。缓存在整个进程内共享，可在任意 isolate 调用。
   ///
-  /// 抛出 [BergamotException] 如果翻译失败。
-  static List<String> pivotMultiple(
-    List<String> inputs,
-    String firstKey,
-    String secondKey,
-  ) {
-    if (inputs.isEmpty) {
-      return [];
-    }
-
+  /// 这是译文缓存而不是分词缓存：未命中的输入（包括缓存关闭时）仍照常断句与子词编码。
+  static void setResultCache(int capacity) {
+    _ensureInitialized();
+    final result = _bindings!.bergamot_set_result_cache(capacity);
+    if (result != 0) {
+      throw BergamotException('Failed to configure result cache', result);
+    }
+  }
+
+  /// 立即回收空闲内存
+  ///
+  /// 翻译过且没有进行中请求的模型换成新实例，释放各工作线程的计算图与工作区，下次翻译时按需重建
+  /// （需要重新读取模型文件，因此第一次翻译会变慢）；结果缓存只保留 [setIdleTrim] 设置的条目数；
+  /// 关闭空闲的守护进程连接，并让分配器把空闲页还给操作系统。
+  /// 适合在应用进入后台或收到内存警告时调用。
+  static void trimMemory() {
+    _ensureInitialized();
+    final result = _bindings!.bergamot_trim_memory();
+    if (result != 0) {
+      throw BergamotException('Failed to trim memory', result);
+    }
+  }
+
+  /// 立即回收空闲内存（后台 Isolate 版本），见 [trimMemory]
+  static Future<void> trimMemoryAsync() {
+    return _BergamotBackground.instance.trimMemory();
+  }
+
+  /// 设置空闲回收
+  ///
+  /// 没有翻译请求持续 [idle] 之后，在原生后台线程上执行一次 [trimMemory]；之后直到下一次请求结束才重新计时。
+  /// [idle] 为 null 时关闭（默认）。[keepCacheEntries] 为回收时结果缓存保留的最近使用条目数，0 表示清空。
+  static void setIdleTrim({Duration? idle, int keepCacheEntries = 0}) {
+    _ensureInitialized();
+    final seconds = idle == null ? 0 : (idle.inSeconds < 1 ? 1 : idle.inSeconds);
+    final result = _bindings!.bergamot_set_idle_trim(seconds, keepCacheEntries);
+    if (result != 0) {
+      throw BergamotException('Failed to set idle trim', result);
+    }
+  }
+
+  /// 开启或关闭请求生命周期追踪（默认关闭）
+  ///
+  /// 开启后每个翻译请求分配一个编号，记录 FFI 调用、缓存查找、排队等待、断句、合并组批、解码、
+  /// 结果提取与输出拷贝等阶段，用 [dumpTrace] 导出。重新开启会清空已有记录；关闭后记录保留，仍可导出。
+  /// [capacity] 为环形缓冲区可容纳的区间数（满后覆盖最旧的记录），0 使用默认值 65536。
+  static void setTracing({bool enabled = true, int capacity = 0}) {
+    _ensureInitialized();
+    final result = _bindings!.bergamot_set_tracing(enabled ? 1 : 0, capacity);
+    if (result != 0) {
+      throw BergamotException('Failed to configure tracing', result);
+    }
+  }
+
+  /// 导出追踪记录
+  ///
+  /// 返回 Chrome trace event 格式的 JSON，保存为文件后可在 ui.perfetto.dev 或 chrome://tracing 中打开，
+  /// 每个请求一条轨道。
+  static String dumpTrace() {
+    _ensureInitialized();
+
+    final jsonPtr = malloc<ffi.Pointer<ffi.Char>>();
+    try {
+      final result = _bindings!.bergamot_dump_trace(jsonPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to dump trace', result);
+      }
+      final json = jsonPtr.value;
+      try {
+        return json.cast<Utf8>().toDartString();
+      } finally {
+        _bindings!.bergamot_free_string(json);
+      }
+    } finally {
+      malloc.free(jsonPtr);
+    }
+  }
+
+  /// 设置退化重复的折叠上限
+  ///
+  /// [maxRepeats] 默认 0（关闭），建议值 8。折叠会改写输入与译文，只在能接受这种改写时开启。
+  /// 输入中连续重复超过该次数的 1~3 词片段在翻译前折叠，避免其解码到长度上限而拖慢同批次的其他句子；译文中的重复循环同样折叠，并截断超过 4 倍长度的同一字母。
+  /// 数字、标点与符号（长编号、分隔线、填空下划线）不视为重复，原样保留。
+  /// 只作用于纯文本翻译，HTML 与 [translateDetailed] 不做处理。
+  static void setRepetitionLimit(int maxRepeats) {
+    _ensureInitialized();
+    final result = _bindings!.bergamot_set_repetition_limit(maxRepeats);
+    if (result != 0) {
+      throw BergamotException('Failed to set repetition limit', result);
+    }
+  }
+
+  /// 设置不需翻译内容的旁路
+  ///
+  /// 两项默认都关闭。
+  /// [segments]：整段为数字、URL、邮箱、哈希时不经过解码器，原样返回（带括号、标点或下划线的文字仍照常翻译）。
+  /// [spans]：句中的 URL、邮箱、哈希先替换为占位符再翻译，之后换回原文；
+  /// 译文没有完整保留占位符时，该输入改为按原文重新翻译。
+  /// 只作用于纯文本翻译，HTML 与 [translateDetailed] 不做处理。
+  static void setPassthrough({bool segments = false, bool spans = false}) {
+    _ensureInitialized();
+    var flags = 0;
+    if (segments) flags |= BERGAMOT_PASSTHROUGH_SEGMENTS;
+    if (spans) flags |= BERGAMOT_PASSTHROUGH_SPANS;
+    final result = _bindings!.bergamot_set_passthrough(flags);
+    if (result != 0) {
+      throw BergamotException('Failed to set passthrough', result);
+    }
+  }
+
+  /// 结果缓存统计
+  static CacheStats resultCacheStats() {
+    _ensureInitialized();
+    final statsPtr = calloc<BergamotCacheStats>();
+    try {
+      final result = _bindings!.bergamot_get_result_cache_stats(statsPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to query result cache stats', result);
+      }
+      final stats = statsPtr.ref;
+      return CacheStats(
+        hits: stats.hits,
+        misses: stats.misses,
+        entries: stats.entries,
+        capacity: stats.capacity,
+      );
+    } finally {
+      calloc.free(statsPtr);
+    }
+  }
+
+  /// 相同请求合并统计
+  ///
+  /// 同一时刻对同一模型、同一输入文本的纯文本翻译请求（包括同一批次内的重复输入）只解码一次，
+  /// 其余请求等待并共享其结果。统计在整个进程内共享。
+  static CoalescingStats coalescingStats() {
+    _ensureInitialized();
+    final statsPtr = calloc<BergamotCoalescingStats>();
+    try {
+      final result = _bindings!.bergamot_get_coalescing_stats(statsPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to query coalescing stats', result);
+      }
+      final stats = statsPtr.ref;
+      return CoalescingStats(
+        decoded: stats.decoded,
+        coalesced: stats.coalesced,
+        pending: stats.pending,
+      );
+    } finally {
+      calloc.free(statsPtr);
+    }
+  }
+
+  /// 获取内存统计
+  ///
+  /// 每个已加载模型按组件（权重、词表、短名单、工作区）的占用、结果缓存占用，以及进程常驻内存。
+  /// 模型各项为加载时交给 bergamot 的内存与按配置预留的工作区，不含 marian 的临时分配，
+  /// 与 [MemoryStats.processResidentBytes] 的差值即为其余部分。
+  /// 客户端模式（[connectDaemon]）下只反映本进程。
+  static MemoryStats memoryStats() {
+    _ensureInitialized();
+    final statsPtr = calloc<ffi.Pointer<BergamotMemoryStats>>();
+    try {
+      final result = _bindings!.bergamot_get_memory_stats(statsPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to query memory stats', result);
+      }
+      final stats = statsPtr.value.ref;
+      try {
+        final models = <ModelMemory>[];
+        for (int i = 0; i < stats.model_count; i++) {
+          final model = stats.models[i];
+          models.add(ModelMemory(
+            key: model.key.cast<Utf8>().toDartString(),
+            modelBytes: model.model_bytes,
+            vocabBytes: model.vocab_bytes,
+            shortlistBytes: model.shortlist_bytes,
+            otherBytes: model.other_bytes,
+            workspaceBytes: model.workspace_bytes,
+            workers: model.workers,
+          ));
+        }
+        return MemoryStats(
+          models: models,
+          vocabBytes: stats.vocab_bytes,
+          resultCacheBytes: stats.result_cache_bytes,
+          resultCacheEntries: stats.result_cache_entries,
+          trackedBytes: stats.tracked_bytes,
+          processResidentBytes: stats.process_resident_bytes < 0 ? null : stats.process_resident_bytes,
+          processPeakResidentBytes:
+              stats.process_peak_resident_bytes < 0 ? null : stats.process_peak_resident_bytes,
+        );
+      } finally {
+        _bindings!.bergamot_free_memory_stats(statsPtr.value);
+      }
+    } finally {
+      calloc.free(statsPtr);
+    }
+  }
+
+  /// 批量翻译
+  ///
+  /// [inputs] 要翻译的文本列表
+  /// [key] 模型缓存键（必须已通过 [loadModel] 加载）
+  ///
+  /// 返回翻译结果列表，顺序与输入列表对应。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static List<String> translateMultiple(List<String> inputs, String key) {
+    if (inputs.isEmpty) {
+      return [];
+    }
+
+    _ensureInitialized();
+
+    // 分配输入字符串数组
+    final inputPtrs = inputs
+        .map((s) => s.toNativeUtf8().cast<ffi.Char>())
+        .toList();
+    final inputsArray = malloc.allocate<ffi.Pointer<ffi.Char>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Char>>() * inputs.length,
+    );
+
+    for (int i = 0; i < inputs.length; i++) {
+      inputsArray[i] = inputPtrs[i];
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    final outputsPtr = malloc.allocate<ffi.Pointer<ffi.Pointer<ffi.Char>>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Pointer<ffi.Char>>>(),
+    );
+    final outputCountPtr = malloc<ffi.Int32>(ffi.sizeOf<ffi.Int32>());
+
+    try {
+      final result = _bindings!.bergamot_translate_multiple(
+        inputsArray,
+        inputs.length,
+        keyPtr,
+        outputsPtr,
+        outputCountPtr.cast(),
+      );
+
+      if (result != 0) {
+        throw BergamotException('Failed to translate', result);
+      }
+
+      final outputCount = outputCountPtr[0];
+      final outputsArray = outputsPtr.value;
+
+      final translations = <String>[];
+      for (int i = 0; i < outputCount; i++) {
+        final strPtr = outputsArray[i];
+        translations.add(strPtr.cast<Utf8>().toDartString());
+      }
+
+      // 释放 C 分配的内存
+      _bindings!.bergamot_free_string_array(outputsArray, outputCount);
+
+      return translations;
+    } finally {
+      // 释放输入字符串
+      for (final ptr in inputPtrs) {
+        malloc.free(ptr);
+      }
+      malloc.free(inputsArray);
+      malloc.free(keyPtr);
+      malloc.free(outputsPtr);
+      malloc.free(outputCountPtr);
+    }
+  }
+
+  /// 批量翻译（后台 Isolate 版本）
+  ///
+  /// 推荐在 Flutter 场景使用：避免同步 FFI 阻塞 UI isolate。
+  /// 输入含 U+0000 时以 [ArgumentError] 失败。
+  static Future<List<String>> translateMultipleAsync(List<String> inputs, String key) {
+    return _BergamotBackground.instance.translateMultiple(inputs, key);
+  }
+
+  /// 打包批量翻译：[inputs] 与返回值都是依次相连、各以 0 结尾的 UTF-8 字节，
+  /// [pivotKey] 不为 null 时经 [key] → [pivotKey] 两段翻译。
+  /// 供后台 isolate 使用，译文整块复制进 [TransferableTypedData] 后交回主 isolate。
+  static TransferableTypedData _translatePacked(Uint8List inputs, String key, String? pivotKey) {
+    _ensureInitialized();
+
+    final inputsPtr = malloc<ffi.Uint8>(inputs.isEmpty ? 1 : inputs.length);
+    inputsPtr.asTypedList(inputs.length).setAll(0, inputs);
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    final pivotKeyPtr = pivotKey == null ? ffi.nullptr : pivotKey.toNativeUtf8().cast<ffi.Char>();
+    final outputPtr = malloc<ffi.Pointer<ffi.Char>>();
+    final outputBytesPtr = malloc<ffi.Int64>();
+
+    try {
+      final result = _bindings!.bergamot_translate_packed(
+        keyPtr,
+        pivotKeyPtr,
+        inputsPtr.cast(),
+        inputs.length,
+        outputPtr,
+        outputBytesPtr,
+      );
+
+      if (result != 0) {
+        throw BergamotException('Failed to translate', result);
+      }
+
+      final output = outputPtr.value;
+      try {
+        return TransferableTypedData.fromList(
+          [output.cast<ffi.Uint8>().asTypedList(outputBytesPtr.value)],
+        );
+      } finally {
+        _bindings!.bergamot_free_string(output);
+      }
+    } finally {
+      malloc.free(inputsPtr);
+      malloc.free(keyPtr);
+      if (pivotKeyPtr != ffi.nullptr) {
+        malloc.free(pivotKeyPtr);
+      }
+      malloc.free(outputPtr);
+      malloc.free(outputBytesPtr);
+    }
+  }
+
+  /// 批量翻译并返回结构化结果
+  ///
+  /// [qualityScores] 计算句子与词级质量分数。模型配置中设置了 `skip-cost: true` 时不计算解码得分，
+  /// 不能请求质量分数
+  /// [alignment] 计算源词-目标词对齐，只保留概率不低于 [alignmentThreshold] 的对齐点
+  /// [sentenceMappings] 返回源句与译句的字节区间
+  /// [html] 输入为 HTML：只翻译文本内容，标签原样保留在译文中，跨标签的句子仍整句翻译；
+  /// 此时字节区间相对于带标签的原文/译文
+  ///
+  /// 只有请求的部分会被计算和复制；全部为 false 时代价与 [translateMultiple] 相同。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static TranslationDetails translateDetailed(
+    List<String> inputs,
+    String key, {
+    bool qualityScores = false,
+    bool alignment = false,
+    bool sentenceMappings = false,
+    bool html = false,
+    double alignmentThreshold = 0.2,
+  }) {
+    if (inputs.isEmpty) {
+      return TranslationDetails(targets: const [], inputSentences: Int32List(1));
+    }
+
+    _ensureInitialized();
+
+    final inputPtrs = inputs
+        .map((s) => s.toNativeUtf8().cast<ffi.Char>())
+        .toList();
+    final inputsArray = malloc.allocate<ffi.Pointer<ffi.Char>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Char>>() * inputs.length,
+    );
+    for (int i = 0; i < inputs.length; i++) {
+      inputsArray[i] = inputPtrs[i];
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    final resultPtr = malloc<ffi.Pointer<BergamotTranslationResult>>();
+
+    var options = 0;
+    if (qualityScores) options |= BERGAMOT_RESULT_QUALITY_SCORES;
+    if (alignment) options |= BERGAMOT_RESULT_ALIGNMENT;
+    if (sentenceMappings) options |= BERGAMOT_RESULT_SENTENCE_MAPPINGS;
+    if (html) options |= BERGAMOT_RESULT_HTML;
+
+    try {
+      final status = _bindings!.bergamot_translate_detailed(
+        inputsArray,
+        inputs.length,
+        keyPtr,
+        options,
+        alignmentThreshold,
+        resultPtr,
+      );
+      if (status != 0) {
+        throw BergamotException('Failed to translate', status);
+      }
+
+      final native = resultPtr.value;
+      try {
+        return _copyDetails(native.ref);
+      } finally {
+        _bindings!.bergamot_free_translation_result(native);
+      }
+    } finally {
+      for (final ptr in inputPtrs) {
+        malloc.free(ptr);
+      }
+      malloc.free(inputsArray);
+      malloc.free(keyPtr);
+      malloc.free(resultPtr);
+    }
+  }
+
+  /// 批量翻译并返回结构化结果（后台 Isolate 版本）
+  static Future<TranslationDetails> translateDetailedAsync(
+    List<String> inputs,
+    String key, {
+    bool qualityScores = false,
+    bool alignment = false,
+    bool sentenceMappings = false,
+    bool html = false,
+    double alignmentThreshold = 0.2,
+  }) {
+    return _BergamotBackground.instance.translateDetailed(
+      inputs,
+      key,
+      qualityScores,
+      alignment,
+      sentenceMappings,
+      html,
+      alignmentThreshold,
+    );
+  }
+
+  /// 批量翻译 HTML 片段或整页
+  ///
+  /// 标签原样保留，只翻译文本内容。整页内容可以作为一条输入在一次调用中批量翻译。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static List<String> translateHtml(List<String> inputs, String key) {
+    return translateDetailed(inputs, key, html: true).targets;
+  }
+
+  /// 批量翻译 HTML（后台 Isolate 版本）
+  static Future<List<String>> translateHtmlAsync(List<String> inputs, String key) async {
+    final details = await translateDetailedAsync(inputs, key, html: true);
+    return details.targets;
+  }
+
+  static Int32List? _copyInts(ffi.Pointer<ffi.Int> ptr, int length) {
+    if (ptr.address == 0) return null;
+    return Int32List.fromList(ptr.cast<ffi.Int32>().asTypedList(length));
+  }
+
+  static Float32List? _copyFloats(ffi.Pointer<ffi.Float> ptr, int length) {
+    if (ptr.address == 0) return null;
+    return Float32List.fromList(ptr.asTypedList(length));
+  }
+
+  static TranslationDetails _copyDetails(BergamotTranslationResult r) {
+    final sentences = r.sentence_count;
+    return TranslationDetails(
+      targets: [
+        for (int i = 0; i < r.input_count; i++)
+          r.targets[i].cast<Utf8>().toDartString(),
+      ],
+      inputSentences: _copyInts(r.input_sentences, r.input_count + 1)!,
+      sourceSentenceSpans: _copyInts(r.source_sentence_spans, sentences * 2),
+      targetSentenceSpans: _copyInts(r.target_sentence_spans, sentences * 2),
+      sentenceScores: _copyFloats(r.sentence_scores, sentences),
+      sentenceWordScores: _copyInts(r.sentence_word_scores, sentences + 1),
+      wordScores: _copyFloats(r.word_scores, r.word_score_count),
+      wordScoreSpans: _copyInts(r.word_score_spans, r.word_score_count * 2),
+      sentenceSourceWords: _copyInts(r.sentence_source_words, sentences + 1),
+      sourceWordSpans: _copyInts(r.source_word_spans, r.source_word_count * 2),
+      sentenceTargetWords: _copyInts(r.sentence_target_words, sentences + 1),
+      targetWordSpans: _copyInts(r.target_word_spans, r.target_word_count * 2),
+      sentenceAlignments: _copyInts(r.sentence_alignments, sentences + 1),
+      alignmentPoints: _copyInts(r.alignment_points, r.alignment_count * 2),
+      alignmentProbs: _copyFloats(r.alignment_probs, r.alignment_count),
+    );
+  }
+
+  /// 翻译文本文件
+  ///
+  /// 每个非空行作为一条输入，空行与换行符原样保留。文件在原生层流式读取、分块翻译并按顺序写出，
+  /// 不经过 Dart 字符串，读取、解码、写出重叠进行，内存占用与 `chunkBytes * maxInFlight` 成正比。
+  ///
+  /// [chunkBytes] 每块输入字节数（按整行切分），0 使用默认值 64 KiB
+  /// [maxInFlight] 同时翻译中的块数，0 使用默认值（工作线程数，至少 2）
+  /// [html] 每行按 HTML 翻译
+  /// [onProgress] 每写完一块调用一次：已写出的输入字节数、输入文件总字节数
+  ///
+  /// 输出先写入 `outPath.part`，完成后重命名为 [outPath]。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static void translateFile(
+    String inPath,
+    String outPath,
+    String key, {
+    int chunkBytes = 0,
+    int maxInFlight = 0,
+    bool html = false,
+    void Function(int done, int total)? onProgress,
+  }) {
+    _ensureInitialized();
+
+    final inPtr = inPath.toNativeUtf8().cast<ffi.Char>();
+    final outPtr = outPath.toNativeUtf8().cast<ffi.Char>();
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    try {
+      _runFileJob(chunkBytes, maxInFlight, html, onProgress, (options) {
+        final result = _bindings!.bergamot_translate_file(inPtr, outPtr, keyPtr, options);
+        if (result != 0) {
+          throw BergamotException('Failed to translate file', result);
+        }
+      });
+    } finally {
+      malloc.free(inPtr);
+      malloc.free(outPtr);
+      malloc.free(keyPtr);
+    }
+  }
+
+  /// 翻译 JSONL 文件
+  ///
+  /// 每行一条 JSON 记录，翻译其顶层字符串字段 [field]，译文写入 [outputField]
+  /// （为 null 时覆盖 [field]；记录中已有该字段时原位替换，否则追加到记录末尾）。
+  /// 不是对象、缺少该字段或字段不是字符串的记录原样输出。
+  ///
+  /// 记录在原生层流式解析，不同记录的文本一起批量翻译并按输入顺序写回，内存占用与文件大小无关。
+  /// 其余参数见 [translateFile]。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static void translateJsonl(
+    String inPath,
+    String outPath,
+    String key,
+    String field, {
+    String? outputField,
+    int chunkBytes = 0,
+    int maxInFlight = 0,
+    bool html = false,
+    void Function(int done, int total)? onProgress,
+  }) {
+    _ensureInitialized();
+
+    final inPtr = inPath.toNativeUtf8().cast<ffi.Char>();
+    final outPtr = outPath.toNativeUtf8().cast<ffi.Char>();
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    final fieldPtr = field.toNativeUtf8().cast<ffi.Char>();
+    final outputFieldPtr = outputField?.toNativeUtf8().cast<ffi.Char>();
+    try {
+      _runFileJob(chunkBytes, maxInFlight, html, onProgress, (options) {
+        final result = _bindings!.bergamot_translate_jsonl(
+          inPtr,
+          outPtr,
+          keyPtr,
+          fieldPtr,
+          outputFieldPtr ?? ffi.nullptr,
+          options,
+        );
+        if (result != 0) {
+          throw BergamotException('Failed to translate JSONL file', result);
+        }
+      });
+    } finally {
+      malloc.free(inPtr);
+      malloc.free(outPtr);
+      malloc.free(keyPtr);
+      malloc.free(fieldPtr);
+      if (outputFieldPtr != null) {
+        malloc.free(outputFieldPtr);
+      }
+    }
+  }
+
+  static void _runFileJob(
+    int chunkBytes,
+    int maxInFlight,
+    bool html,
+    void Function(int done, int total)? onProgress,
+    void Function(ffi.Pointer<BergamotFileOptions> options) run,
+  ) {
+    final options = calloc<BergamotFileOptions>();
+
+    // 回调在调用线程上同步触发，isolateLocal 即可
+    final callback = onProgress == null
+        ? null
+        : ffi.NativeCallable<BergamotProgressCallbackFunction>.isolateLocal(
+            (int done, int total, ffi.Pointer<ffi.Void> _) => onProgress(done, total),
+          );
+
+    try {
+      options.ref.chunk_bytes = chunkBytes;
+      options.ref.max_in_flight = maxInFlight;
+      options.ref.html = html ? 1 : 0;
+      options.ref.progress = callback?.nativeFunction ?? ffi.nullptr;
+      options.ref.user_data = ffi.nullptr;
+      run(options);
+    } finally {
+      callback?.close();
+      calloc.free(options);
+    }
+  }
+
+  /// 在后台 isolate 中执行文件任务，进度通过端口转发回调用方 isolate
+  static Future<void> _runFileJobAsync(
+    void Function(int done, int total)? onProgress,
+    Future<void> Function(SendPort? progressPort) run,
+  ) async {
+    final progressPort = onProgress == null ? null : ReceivePort();
+    progressPort?.listen((dynamic message) {
+      final values = message as List;
+      onProgress!(values[0] as int, values[1] as int);
+    });
+
+    try {
+      await run(progressPort?.sendPort);
+    } finally {
+      progressPort?.close();
+    }
+  }
+
+  /// 翻译文本文件（后台 Isolate 版本）
+  ///
+  /// [onProgress] 在调用方 isolate 上调用。参数见 [translateFile]。
+  static Future<void> translateFileAsync(
+    String inPath,
+    String outPath,
+    String key, {
+    int chunkBytes = 0,
+    int maxInFlight = 0,
+    bool html = false,
+    void Function(int done, int total)? onProgress,
+  }) {
+    return _runFileJobAsync(
+      onProgress,
+      (progressPort) => _BergamotBackground.instance.translateFile(
+        inPath,
+        outPath,
+        key,
+        chunkBytes,
+        maxInFlight,
+        html,
+        progressPort,
+      ),
+    );
+  }
+
+  /// 翻译 JSONL 文件（后台 Isolate 版本）
+  ///
+  /// [onProgress] 在调用方 isolate 上调用。参数见 [translateJsonl]。
+  static Future<void> translateJsonlAsync(
+    String inPath,
+    String outPath,
+    String key,
+    String field, {
+    String? outputField,
+    int chunkBytes = 0,
+    int maxInFlight = 0,
+    bool html = false,
+    void Function(int done, int total)? onProgress,
+  }) {
+    return _runFileJobAsync(
+      onProgress,
+      (progressPort) => _BergamotBackground.instance.translateJsonl(
+        inPath,
+        outPath,
+        key,
+        field,
+        outputField,
+        chunkBytes,
+        maxInFlight,
+        html,
+        progressPort,
+      ),
+    );
+  }
+
+  /// 翻译单个文本
+  ///
+  /// [input] 要翻译的文本
+  /// [key] 模型缓存键（必须已通过 [loadModel] 加载）
+  ///
+  /// 返回翻译结果。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static String translate(String input, String key) {
+    final results = translateMultiple([input], key);
+    if (results.isEmpty) {
+      throw BergamotException('Translation returned empty result');
+    }
+    return results.first;
+  }
+
+  /// 枢轴翻译（通过中间语言）
+  ///
+  /// [inputs] 要翻译的文本列表
+  /// [firstKey] 第一个模型缓存键（源语言 -> 中间语言）
+  /// [secondKey] 第二个模型缓存键（中间语言 -> 目标语言）
+  ///
+  /// 返回翻译结果列表，顺序与输入列表对应。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static List<String> pivotMultiple(
+    List<String> inputs,
+    String firstKey,
+    String secondKey,
+  ) {
+    if (inputs.isEmpty) {
+      return [];
+    }
+
     _ensureInitialized();
 
     // 分配输入字符串数组
@@ -530,6 +1789,7 @@ class BergamotTranslator {
   /// 枢轴翻译（后台 Isolate 版本）
   ///
   /// 推荐在 Flutter 场景使用：避免同步 FFI 阻塞 UI isolate。
+  /// 输入含 U+0000 时以 [ArgumentError] 失败。
   static Future<List<String>> pivotMultipleAsync(
     List<String> inputs,
     String firstKey,
@@ -538,6 +1798,111 @@ class BergamotTranslator {
     return _BergamotBackground.instance.pivotMultiple(inputs, firstKey, secondKey);
   }
 
+  /// 多目标枢轴翻译：一次翻译到多个目标语言
+  ///
+  /// [inputs] 要翻译的文本列表
+  /// [sourceKey] 第一个模型缓存键（源语言 -> 中间语言）
+  /// [targetKeys] 第二跳模型缓存键列表（中间语言 -> 各目标语言）
+  ///
+  /// 中间语言译文只生成一次，再并行交给各个目标模型。
+  /// 返回 `result[t][i]`：第 t 个目标语言下第 i 个输入的译文。
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static List<List<String>> pivotFanOut(
+    List<String> inputs,
+    String sourceKey,
+    List<String> targetKeys,
+  ) {
+    if (inputs.isEmpty || targetKeys.isEmpty) {
+      return [for (final _ in targetKeys) <String>[]];
+    }
+
+    _ensureInitialized();
+
+    final inputPtrs = inputs
+        .map((s) => s.toNativeUtf8().cast<ffi.Char>())
+        .toList();
+    final inputsArray = malloc.allocate<ffi.Pointer<ffi.Char>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Char>>() * inputs.length,
+    );
+    for (int i = 0; i < inputs.length; i++) {
+      inputsArray[i] = inputPtrs[i];
+    }
+
+    final targetPtrs = targetKeys
+        .map((s) => s.toNativeUtf8().cast<ffi.Char>())
+        .toList();
+    final targetsArray = malloc.allocate<ffi.Pointer<ffi.Char>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Char>>() * targetKeys.length,
+    );
+    for (int i = 0; i < targetKeys.length; i++) {
+      targetsArray[i] = targetPtrs[i];
+    }
+
+    final sourceKeyPtr = sourceKey.toNativeUtf8().cast<ffi.Char>();
+    final outputsPtr = malloc.allocate<ffi.Pointer<ffi.Pointer<ffi.Char>>>(
+      ffi.sizeOf<ffi.Pointer<ffi.Pointer<ffi.Char>>>(),
+    );
+    final outputCountPtr = malloc<ffi.Int32>(ffi.sizeOf<ffi.Int32>());
+
+    try {
+      final result = _bindings!.bergamot_pivot_fan_out(
+        sourceKeyPtr,
+        targetsArray,
+        targetKeys.length,
+        inputsArray,
+        inputs.length,
+        outputsPtr,
+        outputCountPtr.cast(),
+      );
+
+      if (result != 0) {
+        throw BergamotException('Failed to pivot translate', result);
+      }
+
+      final outputCount = outputCountPtr[0];
+      final outputsArray = outputsPtr.value;
+
+      final translations = <List<String>>[];
+      for (int t = 0; t < targetKeys.length; t++) {
+        final row = <String>[];
+        for (int i = 0; i < inputs.length; i++) {
+          final index = t * inputs.length + i;
+          if (index < outputCount) {
+            row.add(outputsArray[index].cast<Utf8>().toDartString());
+          }
+        }
+        translations.add(row);
+      }
+
+      // 释放 C 分配的内存
+      _bindings!.bergamot_free_string_array(outputsArray, outputCount);
+
+      return translations;
+    } finally {
+      for (final ptr in inputPtrs) {
+        malloc.free(ptr);
+      }
+      for (final ptr in targetPtrs) {
+        malloc.free(ptr);
+      }
+      malloc.free(inputsArray);
+      malloc.free(targetsArray);
+      malloc.free(sourceKeyPtr);
+      malloc.free(outputsPtr);
+      malloc.free(outputCountPtr);
+    }
+  }
+
+  /// 多目标枢轴翻译（后台 Isolate 版本）
+  static Future<List<List<String>>> pivotFanOutAsync(
+    List<String> inputs,
+    String sourceKey,
+    List<String> targetKeys,
+  ) {
+    return _BergamotBackground.instance.pivotFanOut(inputs, sourceKey, targetKeys);
+  }
+
   /// 枢轴翻译单个文本（通过中间语言）
   ///
   /// [input] 要翻译的文本
@@ -616,6 +1981,146 @@ class BergamotTranslator {
     return DetectionResult.fromJson(map);
   }
 
+  /// 查询运行时 CPU 特性及选用的矩阵乘法路径
+  ///
+  /// 库按通用基线编译，矩阵乘法内核（intgemm/ruy）在运行时按 CPU 选择，
+  /// 可用于确认当前机器实际走的是哪条路径。
+  static CpuInfo cpuInfo() {
+    _ensureInitialized();
+    final infoPtr = malloc.allocate<BergamotCpuInfo>(ffi.sizeOf<BergamotCpuInfo>());
+    try {
+      final result = _bindings!.bergamot_get_cpu_info(infoPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to query CPU info', result);
+      }
+
+      final info = infoPtr.ref;
+      final pathBytes = <int>[];
+      for (int i = 0; i < 32; i++) {
+        final char = info.gemm_path[i];
+        if (char == 0) break;
+        pathBytes.add(char);
+      }
+
+      return CpuInfo(
+        gemmPath: String.fromCharCodes(pathBytes),
+        hasSsse3: info.has_ssse3 != 0,
+        hasSse41: info.has_sse41 != 0,
+        hasAvx2: info.has_avx2 != 0,
+        hasAvx512bw: info.has_avx512bw != 0,
+        hasAvx512vnni: info.has_avx512vnni != 0,
+        hasNeon: info.has_neon != 0,
+      );
+    } finally {
+      malloc.free(infoPtr);
+    }
+  }
+
+  /// 创建增量翻译会话
+  ///
+  /// [key] 模型缓存键；枢轴翻译时为源语言 -> 中间语言
+  /// [pivotKey] 可选，中间语言 -> 目标语言的模型缓存键
+  ///
+  /// 之后每次编辑都把整篇文本交给 [updateSession]：只有与上一版本不同的句子会重新翻译，
+  /// 其余句子沿用已有译文，因此延迟只取决于改动的句子而不是文档长度。
+  /// 返回的句柄在整个进程内有效，不再使用时调用 [closeSession]。
+  static int createSession(String key, {String? pivotKey}) {
+    _ensureInitialized();
+
+    final keyPtr = key.toNativeUtf8().cast<ffi.Char>();
+    final pivotKeyPtr = pivotKey == null
+        ? ffi.nullptr.cast<ffi.Char>()
+        : pivotKey.toNativeUtf8().cast<ffi.Char>();
+    final sessionPtr = malloc<ffi.Int64>();
+    try {
+      final result = _bindings!.bergamot_session_create(keyPtr, pivotKeyPtr, sessionPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to create translation session', result);
+      }
+      return sessionPtr.value;
+    } finally {
+      malloc.free(keyPtr);
+      if (pivotKeyPtr != ffi.nullptr) {
+        malloc.free(pivotKeyPtr);
+      }
+      malloc.free(sessionPtr);
+    }
+  }
+
+  /// 提交文本的新版本，返回整篇译文
+  ///
+  /// 抛出 [BergamotException] 如果翻译失败。
+  static String updateSession(int session, String text) {
+    _ensureInitialized();
+
+    final textPtr = text.toNativeUtf8().cast<ffi.Char>();
+    final outputPtr = malloc<ffi.Pointer<ffi.Char>>();
+    try {
+      final result = _bindings!.bergamot_session_update(session, textPtr, outputPtr, ffi.nullptr);
+      if (result != 0) {
+        throw BergamotException('Failed to update translation session', result);
+      }
+      final output = outputPtr.value;
+      try {
+        return output.cast<Utf8>().toDartString();
+      } finally {
+        _bindings!.bergamot_free_string(output);
+      }
+    } finally {
+      malloc.free(textPtr);
+      malloc.free(outputPtr);
+    }
+  }
+
+  /// 销毁增量翻译会话
+  static void closeSession(int session) {
+    if (_bindings != null) {
+      _bindings!.bergamot_session_destroy(session);
+    }
+  }
+
+  /// 创建增量翻译会话（后台 Isolate 版本）
+  static Future<int> createSessionAsync(String key, {String? pivotKey}) {
+    return _BergamotBackground.instance.createSession(key, pivotKey);
+  }
+
+  /// 提交文本的新版本（后台 Isolate 版本）
+  static Future<String> updateSessionAsync(int session, String text) {
+    return _BergamotBackground.instance.updateSession(session, text);
+  }
+
+  /// 销毁增量翻译会话（后台 Isolate 版本）
+  static Future<void> closeSessionAsync(int session) {
+    return _BergamotBackground.instance.closeSession(session);
+  }
+
+  /// 连接本地翻译守护进程（bergamot-daemon）
+  ///
+  /// [socketPath] 守护进程监听的 Unix 域套接字路径。守护进程只接受与其同一用户的进程连接。
+  ///
+  /// 连接后 [loadModel]、[loadModelBundle] 以及纯文本翻译（含枢轴、文件、增量会话）都在守护进程中执行，
+  /// 同一主机上的多个进程共享其中常驻的一份模型和同一个批处理池；模型配置中的路径按守护进程解析。
+  /// [translateDetailed] 仍只使用本进程加载的模型。连接在整个进程内生效，仅 Linux、macOS 可用。
+  static void connectDaemon(String socketPath) {
+    _ensureInitialized();
+    final pathPtr = socketPath.toNativeUtf8().cast<ffi.Char>();
+    try {
+      final result = _bindings!.bergamot_connect_daemon(pathPtr);
+      if (result != 0) {
+        throw BergamotException('Failed to connect to daemon', result);
+      }
+    } finally {
+      malloc.free(pathPtr);
+    }
+  }
+
+  /// 断开守护进程，恢复在本进程内加载和翻译
+  static void disconnectDaemon() {
+    if (_bindings != null) {
+      _bindings!.bergamot_disconnect_daemon();
+    }
+  }
+
   /// 清理资源（释放所有模型和服务）
   ///
   /// 在应用程序退出前调用此方法以释放所有资源。
@@ -633,9 +2138,24 @@ class BergamotTranslator {
     _BergamotBackground.instance.shutdown();
   }
 
+  /// 设置后台 worker isolate 数量（默认 1）
+  ///
+  /// 多个 isolate 时，同一模型键的请求固定在同一 isolate 上按顺序执行，不同模型的请求并行进入原生层，
+  /// 避免一个大批量请求挡住其他语言对。初始化、[configureServiceAsync] 与 [cleanupAsync] 在 0 号 isolate 上执行。
+  /// 正在运行的 isolate 在已提交的请求全部完成后才关闭，之后的请求等它们关闭后按新数量启动新的 isolate；
+  /// 原生端已加载的模型与服务不受影响。
+  static void setWorkerIsolates(int count) {
+    if (count < 1) {
+      throw ArgumentError.value(count, 'count', 'must be at least 1');
+    }
+    _BergamotBackground.workerCount = count;
+    _BergamotBackground.instance.restartWhenIdle();
+  }
+
   /// 关闭后台 Isolate
   ///
-  /// 仅关闭 Isolate，不清理 C++ 端资源。
+  /// 仅关闭 Isolate，不清理 C++ 端资源。未完成的请求立即以 [BergamotException] 结束；
+  /// 已进入原生层的调用不会被打断，isolate 在其返回后才真正退出，结果被丢弃。
   /// 通常不需要单独调用，[cleanupAsync] 会自动调用此方法。
   static void shutdownAsync() {
     _BergamotBackground.instance.shutdown();
@@ -39,6 +39,190 @@ class BergamotTranslatorBindings {
   late final _bergamot_initialize_service = _bergamot_initialize_servicePtr
       .asFunction<int Function()>();
 
+  /// 配置翻译服务（线程数、CPU 绑定、NUMA 副本）
+  /// 必须在加载任何模型之前调用；已创建的服务会按新配置重建
+  /// config: 配置结构体指针
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_configure_service(ffi.Pointer<BergamotServiceConfig> config) {
+    return _bergamot_configure_service(config);
+  }
+
+  late final _bergamot_configure_servicePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<BergamotServiceConfig>)>>(
+        'bergamot_configure_service',
+      );
+  late final _bergamot_configure_service = _bergamot_configure_servicePtr
+      .asFunction<int Function(ffi.Pointer<BergamotServiceConfig>)>();
+
+  /// 设置输入文本级结果缓存的容量（条目数），0 关闭并清空（默认关闭）
+  /// 以 (模型内容, 输入文本) 为键，命中时跳过断句、子词编码与解码；
+  /// 所有服务副本共享，同一模型重新加载后仍然有效。HTML 与结构化结果不经过此缓存
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_result_cache(int capacity) {
+    return _bergamot_set_result_cache(capacity);
+  }
+
+  late final _bergamot_set_result_cachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int)>>(
+        'bergamot_set_result_cache',
+      );
+  late final _bergamot_set_result_cache = _bergamot_set_result_cachePtr
+      .asFunction<int Function(int)>();
+
+  /// 获取结果缓存统计（命中、未命中、条目数、容量）
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_get_result_cache_stats(ffi.Pointer<BergamotCacheStats> stats) {
+    return _bergamot_get_result_cache_stats(stats);
+  }
+
+  late final _bergamot_get_result_cache_statsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<BergamotCacheStats>)>>(
+        'bergamot_get_result_cache_stats',
+      );
+  late final _bergamot_get_result_cache_stats = _bergamot_get_result_cache_statsPtr
+      .asFunction<int Function(ffi.Pointer<BergamotCacheStats>)>();
+
+  /// 获取相同请求合并统计
+  /// 同一时刻对同一模型、同一输入文本的纯文本翻译请求只解码一次，其余请求共享结果
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_get_coalescing_stats(ffi.Pointer<BergamotCoalescingStats> stats) {
+    return _bergamot_get_coalescing_stats(stats);
+  }
+
+  late final _bergamot_get_coalescing_statsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<BergamotCoalescingStats>)>>(
+        'bergamot_get_coalescing_stats',
+      );
+  late final _bergamot_get_coalescing_stats = _bergamot_get_coalescing_statsPtr
+      .asFunction<int Function(ffi.Pointer<BergamotCoalescingStats>)>();
+
+  /// 获取内存统计：每个已加载模型按组件的占用、结果缓存占用，以及进程常驻内存
+  /// 模型各项为加载时交给 bergamot 的内存与按配置预留的工作区，不含 marian 的临时分配；
+  /// 客户端模式下模型在守护进程中，这里只反映本进程
+  /// stats: 输出结果（整个结果位于一块内存中）
+  /// 返回: 0 成功, 非0 失败
+  /// 注意: stats 需要调用 bergamot_free_memory_stats 释放
+  int bergamot_get_memory_stats(
+    ffi.Pointer<ffi.Pointer<BergamotMemoryStats>> stats,
+  ) {
+    return _bergamot_get_memory_stats(stats);
+  }
+
+  late final _bergamot_get_memory_statsPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Pointer<BergamotMemoryStats>>)>
+      >('bergamot_get_memory_stats');
+  late final _bergamot_get_memory_stats = _bergamot_get_memory_statsPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Pointer<BergamotMemoryStats>>)>();
+
+  /// 释放内存统计
+  void bergamot_free_memory_stats(
+    ffi.Pointer<BergamotMemoryStats> stats,
+  ) {
+    return _bergamot_free_memory_stats(stats);
+  }
+
+  late final _bergamot_free_memory_statsPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<BergamotMemoryStats>)>
+      >('bergamot_free_memory_stats');
+  late final _bergamot_free_memory_stats = _bergamot_free_memory_statsPtr
+      .asFunction<void Function(ffi.Pointer<BergamotMemoryStats>)>();
+
+  /// 立即回收空闲内存：翻译过且没有进行中请求的模型换成新实例，释放各工作线程的计算图与工作区
+  /// （下次翻译时按需重建）；结果缓存只保留 bergamot_set_idle_trim 设置的条目数（默认清空，容量不变）；
+  /// 关闭空闲的守护进程连接，并让分配器把空闲页还给操作系统
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_trim_memory() {
+    return _bergamot_trim_memory();
+  }
+
+  late final _bergamot_trim_memoryPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function()>>(
+        'bergamot_trim_memory',
+      );
+  late final _bergamot_trim_memory = _bergamot_trim_memoryPtr
+      .asFunction<int Function()>();
+
+  /// 设置空闲回收：没有翻译请求持续 idle_seconds 秒后，在后台线程上执行一次 bergamot_trim_memory
+  /// idle_seconds: 0 关闭（默认）
+  /// keep_cache_entries: 回收时结果缓存保留的最近使用条目数，0 表示清空
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_idle_trim(int idle_seconds, int keep_cache_entries) {
+    return _bergamot_set_idle_trim(idle_seconds, keep_cache_entries);
+  }
+
+  late final _bergamot_set_idle_trimPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int, ffi.Int)>>(
+        'bergamot_set_idle_trim',
+      );
+  late final _bergamot_set_idle_trim = _bergamot_set_idle_trimPtr
+      .asFunction<int Function(int, int)>();
+
+  /// 开启或关闭请求生命周期追踪（默认关闭）
+  /// 开启后每个翻译请求分配一个编号，记录 FFI 调用、缓存查找、排队等待、断句、合并组批、解码、
+  /// 结果提取与输出拷贝等阶段；记录写入固定大小的环形缓冲区，满后覆盖最旧的记录
+  /// enabled: 非0 开启（清空已有记录），0 停止记录（已有记录保留，仍可导出）
+  /// capacity: 缓冲区可容纳的区间数，0 使用默认值 65536
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_tracing(int enabled, int capacity) {
+    return _bergamot_set_tracing(enabled, capacity);
+  }
+
+  late final _bergamot_set_tracingPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int, ffi.Int)>>(
+        'bergamot_set_tracing',
+      );
+  late final _bergamot_set_tracing = _bergamot_set_tracingPtr
+      .asFunction<int Function(int, int)>();
+
+  /// 导出追踪记录为 Chrome trace event JSON，可在 ui.perfetto.dev 或 chrome://tracing 中打开，
+  /// 每个请求一条轨道
+  /// json: 输出的 JSON 文本（调用者需要调用 bergamot_free_string 释放）
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_dump_trace(ffi.Pointer<ffi.Pointer<ffi.Char>> json) {
+    return _bergamot_dump_trace(json);
+  }
+
+  late final _bergamot_dump_tracePtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Pointer<ffi.Char>>)>
+      >('bergamot_dump_trace');
+  late final _bergamot_dump_trace = _bergamot_dump_tracePtr
+      .asFunction<int Function(ffi.Pointer<ffi.Pointer<ffi.Char>>)>();
+
+  /// 设置退化重复的折叠上限（默认 0，即关闭；建议值 8）
+  /// 折叠会改写输入与译文，只在能接受这种改写时开启。
+  /// 输入中连续重复超过该次数的 1~3 词片段在翻译前折叠，避免其解码到 max-length 上限而拖慢同批次的其他句子；
+  /// 译文中的重复循环同样折叠，并截断超过 4 倍长度的同一字母。数字、标点与符号不视为重复，原样保留。
+  /// 只作用于纯文本翻译，HTML 与结构化结果（字节区间需对应原文）不做处理
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_repetition_limit(int max_repeats) {
+    return _bergamot_set_repetition_limit(max_repeats);
+  }
+
+  late final _bergamot_set_repetition_limitPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int)>>(
+        'bergamot_set_repetition_limit',
+      );
+  late final _bergamot_set_repetition_limit = _bergamot_set_repetition_limitPtr
+      .asFunction<int Function(int)>();
+
+  /// 设置不需翻译内容的旁路（BERGAMOT_PASSTHROUGH_* 按位组合，0 关闭，默认关闭）
+  /// 使用 BERGAMOT_PASSTHROUGH_SPANS 时，若译文未完整保留占位符，该输入改为按原文重新翻译
+  /// 只作用于纯文本翻译，HTML 与结构化结果不做处理
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_passthrough(int flags) {
+    return _bergamot_set_passthrough(flags);
+  }
+
+  late final _bergamot_set_passthroughPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int)>>(
+        'bergamot_set_passthrough',
+      );
+  late final _bergamot_set_passthrough = _bergamot_set_passthroughPtr
+      .asFunction<int Function(int)>();
+
   /// 加载模型到缓存
   /// cfg: 模型配置字符串（JSON格式）
   /// key: 模型缓存键
@@ -59,6 +243,84 @@ class BergamotTranslatorBindings {
   late final _bergamot_load_model = _bergamot_load_modelPtr
       .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
 
+  /// 从单文件模型包（.bgtb，由 bergamot-bundle 工具生成）加载模型到缓存
+  /// 映射整个文件读取权重、词表、shortlist 与预解析配置，不再逐个打开文件，也无需解析 YAML
+  /// path: 模型包路径
+  /// key: 模型缓存键
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_load_model_bundle(
+    ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<ffi.Char> key,
+  ) {
+    return _bergamot_load_model_bundle(path, key);
+  }
+
+  late final _bergamot_load_model_bundlePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)
+        >
+      >('bergamot_load_model_bundle');
+  late final _bergamot_load_model_bundle = _bergamot_load_model_bundlePtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
+
+  /// 替换 key 下已加载的模型（例如更新到新版本），不中断翻译；key 不存在时等同于加载
+  /// 新模型在后台构造，期间请求照常使用旧模型；构造完成后原子换入，之后的请求使用新模型。
+  /// 进行中的请求在旧模型上完成，旧模型在最后一个请求结束时释放。构造失败时旧模型保持不变
+  /// 参数与 bergamot_load_model 相同
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_replace_model(
+    ffi.Pointer<ffi.Char> cfg,
+    ffi.Pointer<ffi.Char> key,
+  ) {
+    return _bergamot_replace_model(cfg, key);
+  }
+
+  late final _bergamot_replace_modelPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)
+        >
+      >('bergamot_replace_model');
+  late final _bergamot_replace_model = _bergamot_replace_modelPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
+
+  /// 以模型包替换 key 下已加载的模型，行为与 bergamot_replace_model 相同
+  /// 参数与 bergamot_load_model_bundle 相同
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_replace_model_bundle(
+    ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<ffi.Char> key,
+  ) {
+    return _bergamot_replace_model_bundle(path, key);
+  }
+
+  late final _bergamot_replace_model_bundlePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)
+        >
+      >('bergamot_replace_model_bundle');
+  late final _bergamot_replace_model_bundle = _bergamot_replace_model_bundlePtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
+
+  /// 设置预处理权重缓存（默认关闭）
+  /// 启用后，首次加载 intgemm 模型时把按当前 CPU 指令集重排好的权重写入缓存文件，
+  /// 之后加载直接使用缓存，跳过加载期的权重重排。只影响之后加载的模型。
+  /// enabled: 1 启用, 0 禁用
+  /// cache_dir: 缓存目录（可为NULL，表示写在模型文件旁边）
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_set_weight_cache(int enabled, ffi.Pointer<ffi.Char> cache_dir) {
+    return _bergamot_set_weight_cache(enabled, cache_dir);
+  }
+
+  late final _bergamot_set_weight_cachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Char>)>>(
+        'bergamot_set_weight_cache',
+      );
+  late final _bergamot_set_weight_cache = _bergamot_set_weight_cachePtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Char>)>();
+
   /// 批量翻译
   /// inputs: 输入字符串数组
   /// input_count: 输入字符串数量
@@ -158,6 +420,116 @@ class BergamotTranslatorBindings {
         )
       >();
 
+  /// 多目标枢轴翻译：源语言 -> 中间语言只翻译一次，再并行翻译到每个目标语言
+  /// source_key: 第一个模型缓存键（源语言 -> 中间语言）
+  /// target_keys: 第二跳模型缓存键数组（中间语言 -> 各目标语言）
+  /// target_count: 目标模型数量
+  /// inputs: 输入字符串数组
+  /// input_count: 输入字符串数量
+  /// outputs: 输出字符串数组，共 target_count * input_count 个，
+  /// 第 t 个目标的第 i 个输入位于 outputs[t * input_count + i]
+  /// output_count: 输出字符串数量
+  /// 返回: 0 成功, 非0 失败
+  /// 注意: outputs 需要调用 bergamot_free_string_array 释放
+  int bergamot_pivot_fan_out(
+    ffi.Pointer<ffi.Char> source_key,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> target_keys,
+    int target_count,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> inputs,
+    int input_count,
+    ffi.Pointer<ffi.Pointer<ffi.Pointer<ffi.Char>>> outputs,
+    ffi.Pointer<ffi.Int> output_count,
+  ) {
+    return _bergamot_pivot_fan_out(
+      source_key,
+      target_keys,
+      target_count,
+      inputs,
+      input_count,
+      outputs,
+      output_count,
+    );
+  }
+
+  late final _bergamot_pivot_fan_outPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Int,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Int,
+            ffi.Pointer<ffi.Pointer<ffi.Pointer<ffi.Char>>>,
+            ffi.Pointer<ffi.Int>,
+          )
+        >
+      >('bergamot_pivot_fan_out');
+  late final _bergamot_pivot_fan_out = _bergamot_pivot_fan_outPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          int,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          int,
+          ffi.Pointer<ffi.Pointer<ffi.Pointer<ffi.Char>>>,
+          ffi.Pointer<ffi.Int>,
+        )
+      >();
+
+  /// 批量翻译（连续缓冲区格式）
+  /// 输入、输出均为依次相连、各以 '\0' 结尾的 UTF-8 字符串，整批只需一次复制即可跨线程/isolate 传递；
+  /// 输出条数与输入相同，译文中的 '\0' 被去掉
+  /// key: 模型缓存键（枢轴翻译时为源语言 -> 中间语言）
+  /// pivot_key: 第二个模型缓存键（中间语言 -> 目标语言），直接翻译时为 NULL
+  /// inputs / input_bytes: 输入缓冲区及其字节数（含结尾的 '\0'）
+  /// outputs / output_bytes: 输出缓冲区及其字节数，顺序与输入对应
+  /// 返回: 0 成功, 非0 失败
+  /// 注意: outputs 需要调用 bergamot_free_string 释放
+  int bergamot_translate_packed(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> pivot_key,
+    ffi.Pointer<ffi.Char> inputs,
+    int input_bytes,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> outputs,
+    ffi.Pointer<ffi.Int64> output_bytes,
+  ) {
+    return _bergamot_translate_packed(
+      key,
+      pivot_key,
+      inputs,
+      input_bytes,
+      outputs,
+      output_bytes,
+    );
+  }
+
+  late final _bergamot_translate_packedPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Int64,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Pointer<ffi.Int64>,
+          )
+        >
+      >('bergamot_translate_packed');
+  late final _bergamot_translate_packed = _bergamot_translate_packedPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          int,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          ffi.Pointer<ffi.Int64>,
+        )
+      >();
+
   /// 语言检测
   /// text: 待检测文本
   /// hint: 语言提示（可选，可为NULL）
@@ -190,6 +562,49 @@ class BergamotTranslatorBindings {
         )
       >();
 
+  /// 查询运行时检测到的 CPU 特性及选用的矩阵乘法路径
+  /// 库按通用基线编译，intgemm/ruy 在运行时按 CPU 选择 SSSE3/AVX2/AVX512/NEON 内核
+  /// info: 结果结构体指针
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_get_cpu_info(ffi.Pointer<BergamotCpuInfo> info) {
+    return _bergamot_get_cpu_info(info);
+  }
+
+  late final _bergamot_get_cpu_infoPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<BergamotCpuInfo>)>>(
+        'bergamot_get_cpu_info',
+      );
+  late final _bergamot_get_cpu_info = _bergamot_get_cpu_infoPtr
+      .asFunction<int Function(ffi.Pointer<BergamotCpuInfo>)>();
+
+  /// 连接本地翻译守护进程（bergamot-daemon），进入客户端模式
+  /// 之后 bergamot_load_model、bergamot_load_model_bundle 以及纯文本翻译（含枢轴、文件、会话）
+  /// 都转发给守护进程执行，多个进程共享其中常驻的一份模型；模型配置中的路径按守护进程解析。
+  /// 结构化结果（bergamot_translate_detailed）仍只使用本进程加载的模型。
+  /// 仅 Linux、macOS 可用
+  /// socket_path: 守护进程监听的 Unix 域套接字路径
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_connect_daemon(ffi.Pointer<ffi.Char> socket_path) {
+    return _bergamot_connect_daemon(socket_path);
+  }
+
+  late final _bergamot_connect_daemonPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Char>)>>(
+        'bergamot_connect_daemon',
+      );
+  late final _bergamot_connect_daemon = _bergamot_connect_daemonPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>)>();
+
+  /// 断开守护进程，恢复在本进程内加载和翻译
+  void bergamot_disconnect_daemon() {
+    return _bergamot_disconnect_daemon();
+  }
+
+  late final _bergamot_disconnect_daemonPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function()>>('bergamot_disconnect_daemon');
+  late final _bergamot_disconnect_daemon = _bergamot_disconnect_daemonPtr
+      .asFunction<void Function()>();
+
   /// 清理资源（释放所有模型和服务）
   void bergamot_cleanup() {
     return _bergamot_cleanup();
@@ -200,8 +615,243 @@ class BergamotTranslatorBindings {
   late final _bergamot_cleanup = _bergamot_cleanupPtr
       .asFunction<void Function()>();
 
+  /// 创建增量翻译会话
+  /// 每次提交整篇文本，只重新翻译与上一版本不同的句子，其余句子沿用已有译文
+  /// key: 模型缓存键（枢轴翻译时为源语言 -> 中间语言）
+  /// pivot_key: 第二个模型缓存键（中间语言 -> 目标语言），直接翻译时为 NULL
+  /// session: 输出会话句柄，进程内有效
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_session_create(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> pivot_key,
+    ffi.Pointer<ffi.Int64> session,
+  ) {
+    return _bergamot_session_create(key, pivot_key, session);
+  }
+
+  late final _bergamot_session_createPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Int64>,
+          )
+        >
+      >('bergamot_session_create');
+  late final _bergamot_session_create = _bergamot_session_createPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Int64>,
+        )
+      >();
+
+  /// 提交文本的新版本
+  /// output: 整篇译文（调用者需要调用 bergamot_free_string 释放）
+  /// translated_sentences: 本次实际解码的句子数（可为 NULL）
+  /// 同一会话的多次提交按顺序执行
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_session_update(
+    int session,
+    ffi.Pointer<ffi.Char> text,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> output,
+    ffi.Pointer<ffi.Int> translated_sentences,
+  ) {
+    return _bergamot_session_update(session, text, output, translated_sentences);
+  }
+
+  late final _bergamot_session_updatePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Int64,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Pointer<ffi.Int>,
+          )
+        >
+      >('bergamot_session_update');
+  late final _bergamot_session_update = _bergamot_session_updatePtr
+      .asFunction<
+        int Function(
+          int,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          ffi.Pointer<ffi.Int>,
+        )
+      >();
+
+  /// 销毁会话
+  void bergamot_session_destroy(int session) {
+    return _bergamot_session_destroy(session);
+  }
+
+  late final _bergamot_session_destroyPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int64)>>(
+        'bergamot_session_destroy',
+      );
+  late final _bergamot_session_destroy = _bergamot_session_destroyPtr
+      .asFunction<void Function(int)>();
+
+  /// 批量翻译并返回结构化结果（质量分数、对齐、句子映射）
+  /// inputs: 输入字符串数组
+  /// input_count: 输入字符串数量
+  /// key: 模型缓存键
+  /// options: BERGAMOT_RESULT_* 按位组合；0 时与 bergamot_translate_multiple 代价相同
+  ///          BERGAMOT_RESULT_HTML 时字节区间相对于带标签的原文/译文
+  /// alignment_threshold: 只返回概率不低于该值的对齐点（仅 BERGAMOT_RESULT_ALIGNMENT）
+  /// result: 输出结果（整个结果位于一块内存中）
+  /// 返回: 0 成功, 非0 失败
+  /// 注意: result 需要调用 bergamot_free_translation_result 释放
+  int bergamot_translate_detailed(
+    ffi.Pointer<ffi.Pointer<ffi.Char>> inputs,
+    int input_count,
+    ffi.Pointer<ffi.Char> key,
+    int options,
+    double alignment_threshold,
+    ffi.Pointer<ffi.Pointer<BergamotTranslationResult>> result,
+  ) {
+    return _bergamot_translate_detailed(
+      inputs,
+      input_count,
+      key,
+      options,
+      alignment_threshold,
+      result,
+    );
+  }
+
+  late final _bergamot_translate_detailedPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Pointer<ffi.Char>>,
+            ffi.Int,
+            ffi.Pointer<ffi.Char>,
+            ffi.Int,
+            ffi.Float,
+            ffi.Pointer<ffi.Pointer<BergamotTranslationResult>>,
+          )
+        >
+      >('bergamot_translate_detailed');
+  late final _bergamot_translate_detailed = _bergamot_translate_detailedPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          int,
+          ffi.Pointer<ffi.Char>,
+          int,
+          double,
+          ffi.Pointer<ffi.Pointer<BergamotTranslationResult>>,
+        )
+      >();
+
+  /// 翻译文本文件：每个非空行作为一条输入，空行与换行符原样保留
+  /// 流式读取并分块翻译，按输入顺序写出，读取/解码/写出重叠进行
+  /// in_path: 输入文件路径（UTF-8）
+  /// out_path: 输出文件路径；先写入 out_path + ".part"，完成后重命名
+  /// key: 模型缓存键
+  /// options: 选项，可为 NULL
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_translate_file(
+    ffi.Pointer<ffi.Char> in_path,
+    ffi.Pointer<ffi.Char> out_path,
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<BergamotFileOptions> options,
+  ) {
+    return _bergamot_translate_file(in_path, out_path, key, options);
+  }
+
+  late final _bergamot_translate_filePtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<BergamotFileOptions>,
+          )
+        >
+      >('bergamot_translate_file');
+  late final _bergamot_translate_file = _bergamot_translate_filePtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<BergamotFileOptions>,
+        )
+      >();
+
+  /// 翻译 JSONL 文件：每行一条 JSON 记录，翻译其顶层字符串字段
+  /// 不同记录的文本一起批量翻译，按输入顺序写回，内存占用与文件大小无关
+  /// field: 要翻译的字段名
+  /// output_field: 译文写入的字段名；NULL 或空字符串时覆盖 field
+  /// （记录中已有该字段时原位替换，否则追加到记录末尾）
+  /// 不是对象、缺少该字段或字段不是字符串的记录原样输出
+  /// 其余参数与 bergamot_translate_file 相同
+  /// 返回: 0 成功, 非0 失败
+  int bergamot_translate_jsonl(
+    ffi.Pointer<ffi.Char> in_path,
+    ffi.Pointer<ffi.Char> out_path,
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> field,
+    ffi.Pointer<ffi.Char> output_field,
+    ffi.Pointer<BergamotFileOptions> options,
+  ) {
+    return _bergamot_translate_jsonl(
+      in_path,
+      out_path,
+      key,
+      field,
+      output_field,
+      options,
+    );
+  }
+
+  late final _bergamot_translate_jsonlPtr =
+      _lookup<
+        ffi.NativeFunction<
+          ffi.Int Function(
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<ffi.Char>,
+            ffi.Pointer<BergamotFileOptions>,
+          )
+        >
+      >('bergamot_translate_jsonl');
+  late final _bergamot_translate_jsonl = _bergamot_translate_jsonlPtr
+      .asFunction<
+        int Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<BergamotFileOptions>,
+        )
+      >();
+
+  /// 释放结构化翻译结果
+  void bergamot_free_translation_result(
+    ffi.Pointer<BergamotTranslationResult> result,
+  ) {
+    return _bergamot_free_translation_result(result);
+  }
+
+  late final _bergamot_free_translation_resultPtr =
+      _lookup<
+        ffi.NativeFunction<ffi.Void Function(ffi.Pointer<BergamotTranslationResult>)>
+      >('bergamot_free_translation_result');
+  late final _bergamot_free_translation_result = _bergamot_free_translation_resultPtr
+      .asFunction<void Function(ffi.Pointer<BergamotTranslationResult>)>();
+
   /// 释放字符串数组内存
-  /// array: 字符串数组指针
+  /// array: 字符串数组指针（指针表与字符串在同一块内存中，不能单独释放元素）
   /// count: 数组元素数量
   void bergamot_free_string_array(
     ffi.Pointer<ffi.Pointer<ffi.Char>> array,
@@ -218,6 +868,19 @@ class BergamotTranslatorBindings {
       >('bergamot_free_string_array');
   late final _bergamot_free_string_array = _bergamot_free_string_arrayPtr
       .asFunction<void Function(ffi.Pointer<ffi.Pointer<ffi.Char>>, int)>();
+
+  /// 释放单个字符串内存
+  /// str: 由 bergamot_session_update、bergamot_translate_packed 或 bergamot_dump_trace 返回的字符串/缓冲区
+  void bergamot_free_string(ffi.Pointer<ffi.Char> str) {
+    return _bergamot_free_string(str);
+  }
+
+  late final _bergamot_free_stringPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Char>)>>(
+        'bergamot_free_string',
+      );
+  late final _bergamot_free_string = _bergamot_free_stringPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Char>)>();
 }
 
 /// 语言检测结果结构体
@@ -234,3 +897,236 @@ final class BergamotDetectionResult extends ffi.Struct {
   @ffi.Int()
   external int confidence;
 }
+
+/// 翻译服务配置
+final class BergamotServiceConfig extends ffi.Struct {
+  /// 工作线程总数；0 表示在调用线程上同步翻译（默认）
+  @ffi.Int()
+  external int num_workers;
+
+  /// 翻译缓存条目数，0 表示禁用（默认 256）
+  @ffi.Int()
+  external int cache_size;
+
+  /// 工作线程允许运行的 CPU 列表（如 "0-7,16-23"），NULL 表示不限制
+  external ffi.Pointer<ffi.Char> cpu_set;
+
+  /// 1: 每个 NUMA 节点一个服务及模型副本（0/1）
+  @ffi.Int()
+  external int numa_replicas;
+
+  /// 断句与子词编码线程数（需 num_workers > 0），0 表示在调用线程上处理
+  @ffi.Int()
+  external int preprocess_threads;
+}
+
+/// CPU 特性与矩阵乘法路径
+final class BergamotCpuInfo extends ffi.Struct {
+  /// 实际使用的 int8 矩阵乘法路径（如 "intgemm-avx2", "ruy-neon"）
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Char> gemm_path;
+
+  /// 以下为检测到的指令集（0/1）
+  @ffi.Int()
+  external int has_ssse3;
+
+  @ffi.Int()
+  external int has_sse41;
+
+  @ffi.Int()
+  external int has_avx2;
+
+  @ffi.Int()
+  external int has_avx512bw;
+
+  @ffi.Int()
+  external int has_avx512vnni;
+
+  @ffi.Int()
+  external int has_neon;
+}
+
+/// bergamot_set_passthrough 的选项（按位组合）
+const int BERGAMOT_PASSTHROUGH_SEGMENTS = 1;
+const int BERGAMOT_PASSTHROUGH_SPANS = 2;
+
+/// bergamot_translate_detailed 的请求选项（按位组合）
+const int BERGAMOT_RESULT_QUALITY_SCORES = 1;
+const int BERGAMOT_RESULT_ALIGNMENT = 2;
+const int BERGAMOT_RESULT_SENTENCE_MAPPINGS = 4;
+const int BERGAMOT_RESULT_HTML = 8;
+
+/// 结构化翻译结果：所有数组按输入、句子顺序平铺
+final class BergamotTranslationResult extends ffi.Struct {
+  @ffi.Int()
+  external int input_count;
+
+  external ffi.Pointer<ffi.Pointer<ffi.Char>> targets;
+
+  @ffi.Int()
+  external int sentence_count;
+
+  external ffi.Pointer<ffi.Int> input_sentences;
+
+  external ffi.Pointer<ffi.Int> source_sentence_spans;
+
+  external ffi.Pointer<ffi.Int> target_sentence_spans;
+
+  external ffi.Pointer<ffi.Float> sentence_scores;
+
+  @ffi.Int()
+  external int word_score_count;
+
+  external ffi.Pointer<ffi.Int> sentence_word_scores;
+
+  external ffi.Pointer<ffi.Float> word_scores;
+
+  external ffi.Pointer<ffi.Int> word_score_spans;
+
+  @ffi.Int()
+  external int source_word_count;
+
+  external ffi.Pointer<ffi.Int> sentence_source_words;
+
+  external ffi.Pointer<ffi.Int> source_word_spans;
+
+  @ffi.Int()
+  external int target_word_count;
+
+  external ffi.Pointer<ffi.Int> sentence_target_words;
+
+  external ffi.Pointer<ffi.Int> target_word_spans;
+
+  @ffi.Int()
+  external int alignment_count;
+
+  external ffi.Pointer<ffi.Int> sentence_alignments;
+
+  external ffi.Pointer<ffi.Int> alignment_points;
+
+  external ffi.Pointer<ffi.Float> alignment_probs;
+}
+
+/// 文件翻译进度回调：已写出的输入字节数、输入文件总字节数
+typedef BergamotProgressCallback =
+    ffi.Pointer<ffi.NativeFunction<BergamotProgressCallbackFunction>>;
+typedef BergamotProgressCallbackFunction =
+    ffi.Void Function(
+      ffi.Int64 bytes_done,
+      ffi.Int64 bytes_total,
+      ffi.Pointer<ffi.Void> user_data,
+    );
+typedef DartBergamotProgressCallbackFunction =
+    void Function(int bytes_done, int bytes_total, ffi.Pointer<ffi.Void> user_data);
+
+/// 文件翻译选项
+final class BergamotFileOptions extends ffi.Struct {
+  /// 每块输入字节数（按整行切分），0 使用默认值 64 KiB
+  @ffi.Int()
+  external int chunk_bytes;
+
+  /// 同时翻译中的块数，0 使用默认值（工作线程数，至少 2）
+  @ffi.Int()
+  external int max_in_flight;
+
+  /// 1: 每行按 HTML 翻译，标签原样保留
+  @ffi.Int()
+  external int html;
+
+  /// 可为 NULL；在调用线程上、每写完一块调用一次
+  external BergamotProgressCallback progress;
+
+  /// 原样传给 progress
+  external ffi.Pointer<ffi.Void> user_data;
+}
+
+/// 结果缓存统计
+final class BergamotCacheStats extends ffi.Struct {
+  @ffi.Int64()
+  external int hits;
+
+  @ffi.Int64()
+  external int misses;
+
+  @ffi.Int64()
+  external int entries;
+
+  @ffi.Int64()
+  external int capacity;
+}
+
+/// 相同请求合并统计
+final class BergamotCoalescingStats extends ffi.Struct {
+  /// 实际交给解码器的输入数
+  @ffi.Int64()
+  external int decoded;
+
+  /// 合并到正在进行的相同解码、未重复解码的输入数
+  @ffi.Int64()
+  external int coalesced;
+
+  /// 当前正在解码的不同输入数
+  @ffi.Int64()
+  external int pending;
+}
+
+/// 单个模型交给翻译服务的内存（字节）；线程池模式下为所有服务副本之和
+final class BergamotModelMemory extends ffi.Struct {
+  /// 模型缓存键
+  external ffi.Pointer<ffi.Char> key;
+
+  /// 权重
+  @ffi.Int64()
+  external int model_bytes;
+
+  /// 词表（与其他模型共享的词表在每个模型中都计入）
+  @ffi.Int64()
+  external int vocab_bytes;
+
+  /// 词表短名单
+  @ffi.Int64()
+  external int shortlist_bytes;
+
+  /// 断句前缀文件、质量估计模型
+  @ffi.Int64()
+  external int other_bytes;
+
+  /// 解码工作区：每个工作线程按配置的 workspace 各预留一份
+  @ffi.Int64()
+  external int workspace_bytes;
+
+  /// 持有该模型工作区的工作线程数
+  @ffi.Int()
+  external int workers;
+}
+
+/// 内存统计
+final class BergamotMemoryStats extends ffi.Struct {
+  @ffi.Int()
+  external int model_count;
+
+  /// [model_count]，按键排序
+  external ffi.Pointer<BergamotModelMemory> models;
+
+  /// 去重后的词表总量
+  @ffi.Int64()
+  external int vocab_bytes;
+
+  /// 结果缓存（估算）
+  @ffi.Int64()
+  external int result_cache_bytes;
+
+  @ffi.Int64()
+  external int result_cache_entries;
+
+  /// 以上各项之和（词表按去重计）
+  @ffi.Int64()
+  external int tracked_bytes;
+
+  /// 进程常驻内存，-1 表示不可用
+  @ffi.Int64()
+  external int process_resident_bytes;
+
+  @ffi.Int64()
+  external int process_peak_resident_bytes;
+}
@@ -1,3 +1,19 @@
 // Relative import to be able to reuse the C sources.
 // See the comment in ../bergamot_translator.podspec for more information.
 #include "../../src/bergamot_translator.cpp"
+#include "../../src/model_bundle.cpp"
+#include "../../src/weight_cache.cpp"
+#include "../../src/cpu_features.cpp"
+#include "../../src/worker_pool.cpp"
+#include "../../src/file_pipeline.cpp"
+#include "../../src/jsonl_codec.cpp"
+#include "../../src/result_cache.cpp"
+#include "../../src/repetition_guard.cpp"
+#include "../../src/inflight_requests.cpp"
+#include "../../src/translation_session.cpp"
+#include "../../src/passthrough_filter.cpp"
+#include "../../src/daemon_protocol.cpp"
+#include "../../src/daemon_client.cpp"
+#include "../../src/process_memory.cpp"
+#include "../../src/idle_trim.cpp"
+#include "../../src/request_trace.cpp"
@@ -0,0 +1,208 @@
+// bergamot-bench: 测量翻译吞吐，并比较不同矩阵乘法路径
+//
+// 用法: bergamot-bench <config.yml> <input.txt> [--repeat N] [--compare] [--compare-decoder]
+//
+// 每行输入作为一条请求，整份输入作为一个批次提交给 bergamot_translate_multiple。
+// 每轮重复翻译同一份输入，因此测量前关闭 bergamot 的句子缓存与插件的结果缓存，
+// 否则第一轮之后测到的只是缓存命中。
+// --compare 时依次以 INTGEMM_CPUID=<ISA> 重新启动自身，对当前 CPU 支持的每个
+// intgemm 路径各测一遍（intgemm 在进程启动时读取该环境变量，因此必须分进程测量）。
+// --compare-decoder 时同一进程内分别以 skip-cost: true（不计算路径得分）和 skip-cost: false
+// 加载模型并各测一遍，用于判断某个模型是否值得在配置中打开 skip-cost；配置中原有的 skip-cost 被覆盖。
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bergamot_translator.h"
+
+namespace {
+    std::string shellQuote(const std::string& s) {
+        std::string quoted = "'";
+        for (char c : s) {
+            if (c == '\'') {
+                quoted += "'\\''";
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "'";
+    }
+
+    // 去掉配置中顶层的 key 行，再追加 key: value（YAML 不允许重复键）
+    std::string overrideOption(const std::string& cfg, const std::string& key, const std::string& value) {
+        std::istringstream in(cfg);
+        std::string out;
+        for (std::string line; std::getline(in, line);) {
+            if (line.compare(0, key.size() + 1, key + ":") == 0) {
+                continue;
+            }
+            out += line + "\n";
+        }
+        return out + key + ": " + value + "\n";
+    }
+
+    size_t countWords(const std::vector<std::string>& lines) {
+        size_t words = 0;
+        for (const auto& line : lines) {
+            std::istringstream in(line);
+            std::string word;
+            while (in >> word) {
+                ++words;
+            }
+        }
+        return words;
+    }
+
+    bool benchmark(const std::string& key, const std::string& cfg, const std::vector<std::string>& lines,
+                   int repeat, bool labelled) {
+        if (labelled) {
+            std::cout << "== " << key << " ==" << std::endl;
+        }
+
+        auto loadStart = std::chrono::steady_clock::now();
+        if (bergamot_load_model(cfg.c_str(), key.c_str()) != 0) {
+            return false;
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "model load: " << loadMs << " ms" << std::endl;
+
+        std::vector<const char*> inputs;
+        for (const auto& line : lines) {
+            inputs.push_back(line.c_str());
+        }
+
+        auto runOnce = [&]() -> bool {
+            char** outputs = nullptr;
+            int outputCount = 0;
+            if (bergamot_translate_multiple(inputs.data(), (int)inputs.size(), key.c_str(), &outputs, &outputCount) != 0) {
+                return false;
+            }
+            bergamot_free_string_array(outputs, outputCount);
+            return true;
+        };
+
+        // 预热：首次翻译会惰性初始化计算图与工作区
+        if (!runOnce()) {
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat; ++i) {
+            if (!runOnce()) {
+                return false;
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t words = countWords(lines) * (size_t)repeat;
+        std::cout << "sentences/s: " << (double)(lines.size() * (size_t)repeat) / seconds << std::endl;
+        std::cout << "words/s: " << (double)words / seconds << std::endl;
+        return true;
+    }
+
+    int compare(const char* self, const std::string& args) {
+        BergamotCpuInfo info;
+        bergamot_get_cpu_info(&info);
+
+        struct Candidate { const char* isa; int supported; };
+        const Candidate candidates[] = {
+            {"AVX512VNNI", info.has_avx512vnni},
+            {"AVX512BW", info.has_avx512bw},
+            {"AVX2", info.has_avx2},
+            {"SSSE3", info.has_ssse3},
+        };
+
+        int status = 0;
+        for (const auto& candidate : candidates) {
+            if (!candidate.supported) {
+                continue;
+            }
+            std::string command = std::string("INTGEMM_CPUID=") + candidate.isa + " " + shellQuote(self) + args;
+            std::cout << "== " << candidate.isa << " ==" << std::endl;
+            if (std::system(command.c_str()) != 0) {
+                status = 1;
+            }
+        }
+        return status;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <config.yml> <input.txt> [--repeat N] [--compare] [--compare-decoder]" << std::endl;
+        return 2;
+    }
+
+    int repeat = 5;
+    bool doCompare = false;
+    bool compareDecoder = false;
+    std::string passThrough = " " + shellQuote(argv[1]) + " " + shellQuote(argv[2]);
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::atoi(argv[++i]);
+            passThrough += " --repeat " + std::to_string(repeat);
+        } else if (std::strcmp(argv[i], "--compare") == 0) {
+            doCompare = true;
+        } else if (std::strcmp(argv[i], "--compare-decoder") == 0) {
+            compareDecoder = true;
+            passThrough += " --compare-decoder";
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            return 2;
+        }
+    }
+
+    if (doCompare) {
+        return compare(argv[0], passThrough);
+    }
+
+    std::ifstream cfgIn(argv[1]);
+    std::stringstream cfg;
+    cfg << cfgIn.rdbuf();
+
+    std::vector<std::string> lines;
+    std::ifstream textIn(argv[2]);
+    for (std::string line; std::getline(textIn, line);) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    if (!cfgIn || lines.empty()) {
+        std::cerr << "Cannot read config or input" << std::endl;
+        return 1;
+    }
+
+    // 服务配置必须在加载模型之前完成
+    BergamotServiceConfig config{};
+    config.cache_size = 0;
+    if (bergamot_configure_service(&config) != 0 || bergamot_set_result_cache(0) != 0) {
+        return 1;
+    }
+
+    BergamotCpuInfo info;
+    bergamot_get_cpu_info(&info);
+    std::cout << "gemm path: " << info.gemm_path << std::endl;
+
+    std::vector<std::pair<std::string, std::string>> variants;
+    if (compareDecoder) {
+        variants.emplace_back("skip-cost", overrideOption(cfg.str(), "skip-cost", "true"));
+        variants.emplace_back("with-cost", overrideOption(cfg.str(), "skip-cost", "false"));
+    } else {
+        variants.emplace_back("bench", cfg.str());
+    }
+
+    for (const auto& variant : variants) {
+        if (!benchmark(variant.first, variant.second, lines, repeat, compareDecoder)) {
+            return 1;
+        }
+    }
+
+    bergamot_cleanup();
+    return 0;
+}
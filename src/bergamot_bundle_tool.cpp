@@ -0,0 +1,37 @@
+// bergamot-bundle: 把 YAML 模型配置及其引用的文件打包成单文件模型包（.bgtb）
+//
+// 用法: bergamot-bundle <config.yml> <output.bgtb>
+//
+// 配置格式与 bergamot_load_model 接收的相同，路径必须是绝对路径。
+// 生成的模型包通过 bergamot_load_model_bundle 加载。
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "model_bundle.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <config.yml> <output.bgtb>" << std::endl;
+        return 2;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Cannot open config: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::stringstream config;
+    config << in.rdbuf();
+
+    try {
+        bergamot_plugin::writeModelBundle(config.str(), argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << argv[2] << std::endl;
+    return 0;
+}
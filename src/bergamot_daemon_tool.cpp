@@ -0,0 +1,266 @@
+// bergamot-daemon: 本地翻译守护进程，让同一主机上的多个进程共享一份常驻模型
+//
+// 用法: bergamot-daemon --socket <path> [--workers N] [--preprocess-threads N] [--idle-trim SECONDS]
+//                       [--model <key>=<config.yml>]... [--bundle <key>=<file.bgtb>]...
+//
+// 启动时预加载 --model/--bundle 指定的模型，之后在 Unix 域套接字上接受请求。
+// 客户端进程调用 bergamot_connect_daemon 后，加载模型与纯文本翻译都转发到这里执行，
+// 所有客户端的请求由同一个翻译服务统一组批。协议见 daemon_protocol.h。
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bergamot_translator.h"
+#include "daemon_protocol.h"
+
+#if defined(BERGAMOT_HAS_DAEMON)
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    using bergamot_plugin::DaemonMessage;
+
+    std::vector<const char*> cStrings(const std::vector<std::string>& strings, size_t first) {
+        std::vector<const char*> pointers;
+        for (size_t i = first; i < strings.size(); ++i) {
+            pointers.push_back(strings[i].c_str());
+        }
+        return pointers;
+    }
+
+    // 翻译失败的具体原因由 C 接口写到守护进程的标准错误
+    bool failed(DaemonMessage& reply, const std::string& what) {
+        reply.status = 1;
+        reply.strings = {what + " failed (see daemon log)"};
+        return false;
+    }
+
+    bool takeStringArray(DaemonMessage& reply, char** outputs, int count) {
+        reply.strings.assign(outputs, outputs + count);
+        bergamot_free_string_array(outputs, count);
+        return true;
+    }
+
+    bool translate(const DaemonMessage& request, DaemonMessage& reply) {
+        const auto& args = request.strings;
+        if (args.size() < 2) {
+            return failed(reply, "translate");
+        }
+        std::vector<const char*> inputs = cStrings(args, 2);
+        if (inputs.empty()) {
+            return true;
+        }
+
+        if (args[1] == "html") {
+            BergamotTranslationResult* result = nullptr;
+            if (bergamot_translate_detailed(inputs.data(), (int)inputs.size(), args[0].c_str(),
+                                            BERGAMOT_RESULT_HTML, 0.0f, &result) != 0) {
+                return failed(reply, "translate");
+            }
+            reply.strings.assign(result->targets, result->targets + result->input_count);
+            bergamot_free_translation_result(result);
+            return true;
+        }
+
+        char** outputs = nullptr;
+        int count = 0;
+        if (bergamot_translate_multiple(inputs.data(), (int)inputs.size(), args[0].c_str(), &outputs, &count) != 0) {
+            return failed(reply, "translate");
+        }
+        return takeStringArray(reply, outputs, count);
+    }
+
+    bool pivot(const DaemonMessage& request, DaemonMessage& reply) {
+        const auto& args = request.strings;
+        if (args.size() < 2) {
+            return failed(reply, "pivot");
+        }
+        std::vector<const char*> inputs = cStrings(args, 2);
+        if (inputs.empty()) {
+            return true;
+        }
+
+        char** outputs = nullptr;
+        int count = 0;
+        if (bergamot_pivot_multiple(args[0].c_str(), args[1].c_str(), inputs.data(), (int)inputs.size(),
+                                    &outputs, &count) != 0) {
+            return failed(reply, "pivot");
+        }
+        return takeStringArray(reply, outputs, count);
+    }
+
+    void handle(const DaemonMessage& request, DaemonMessage& reply) {
+        const auto& args = request.strings;
+        switch (request.type) {
+            case bergamot_plugin::kDaemonPing:
+                break;
+            case bergamot_plugin::kDaemonLoadModel:
+                if (args.size() != 2 || bergamot_load_model(args[0].c_str(), args[1].c_str()) != 0) {
+                    failed(reply, "load model");
+                }
+                break;
+            case bergamot_plugin::kDaemonLoadBundle:
+                if (args.size() != 2 || bergamot_load_model_bundle(args[0].c_str(), args[1].c_str()) != 0) {
+                    failed(reply, "load bundle");
+                }
+                break;
+            case bergamot_plugin::kDaemonReplaceModel:
+                if (args.size() != 2 || bergamot_replace_model(args[0].c_str(), args[1].c_str()) != 0) {
+                    failed(reply, "replace model");
+                }
+                break;
+            case bergamot_plugin::kDaemonReplaceBundle:
+                if (args.size() != 2 || bergamot_replace_model_bundle(args[0].c_str(), args[1].c_str()) != 0) {
+                    failed(reply, "replace bundle");
+                }
+                break;
+            case bergamot_plugin::kDaemonTranslate:
+                translate(request, reply);
+                break;
+            case bergamot_plugin::kDaemonPivot:
+                pivot(request, reply);
+                break;
+            default:
+                reply.status = 1;
+                reply.strings = {"unknown request " + std::to_string(request.type)};
+        }
+    }
+
+    // 每个连接一个线程，连接内的请求按顺序处理
+    void serve(int fd) {
+        DaemonMessage request;
+        while (bergamot_plugin::receiveDaemonMessage(fd, request)) {
+            DaemonMessage reply;
+            reply.type = request.type;
+            handle(request, reply);
+            if (!bergamot_plugin::sendDaemonMessage(fd, reply)) {
+                break;
+            }
+        }
+        close(fd);
+    }
+
+    bool splitAssignment(const char* arg, std::string& key, std::string& value) {
+        const char* eq = std::strchr(arg, '=');
+        if (eq == nullptr || eq == arg || eq[1] == '\0') {
+            return false;
+        }
+        key.assign(arg, eq - arg);
+        value.assign(eq + 1);
+        return true;
+    }
+
+    int usage(const char* program) {
+        std::cerr << "Usage: " << program << " --socket <path> [--workers N] [--preprocess-threads N] [--idle-trim SECONDS]"
+                  << " [--model <key>=<config.yml>]... [--bundle <key>=<file.bgtb>]..." << std::endl;
+        return 2;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string socketPath;
+    BergamotServiceConfig config;
+    std::memset(&config, 0, sizeof(config));
+    config.cache_size = 256;
+    std::vector<std::pair<std::string, std::string>> models;
+    std::vector<std::pair<std::string, std::string>> bundles;
+    int idleTrimSeconds = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string key, value;
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            config.num_workers = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--preprocess-threads") == 0 && i + 1 < argc) {
+            config.preprocess_threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--idle-trim") == 0 && i + 1 < argc) {
+            idleTrimSeconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc && splitAssignment(argv[++i], key, value)) {
+            models.emplace_back(key, value);
+        } else if (std::strcmp(argv[i], "--bundle") == 0 && i + 1 < argc && splitAssignment(argv[++i], key, value)) {
+            bundles.emplace_back(key, value);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (socketPath.empty()) {
+        return usage(argv[0]);
+    }
+
+    // 客户端断开时写套接字不应终止守护进程
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (config.num_workers > 0 && bergamot_configure_service(&config) != 0) {
+        return 1;
+    }
+    for (const auto& model : models) {
+        std::ifstream in(model.second);
+        std::stringstream cfg;
+        cfg << in.rdbuf();
+        if (!in || bergamot_load_model(cfg.str().c_str(), model.first.c_str()) != 0) {
+            std::cerr << "Cannot load model " << model.first << " from " << model.second << std::endl;
+            return 1;
+        }
+    }
+    for (const auto& bundle : bundles) {
+        if (bergamot_load_model_bundle(bundle.second.c_str(), bundle.first.c_str()) != 0) {
+            return 1;
+        }
+    }
+
+    if (idleTrimSeconds > 0 && bergamot_set_idle_trim(idleTrimSeconds, 0) != 0) {
+        return 1;
+    }
+
+    int listener;
+    try {
+        listener = bergamot_plugin::listenDaemonSocket(socketPath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << socketPath << std::endl;
+
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            int error = errno;
+            if (error == EINTR || error == ECONNABORTED || error == EPROTO) {
+                continue;
+            }
+            if (error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM) {
+                // 资源暂时耗尽：等现有连接释放后再接受，避免空转
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            std::cerr << "Error: accept failed: " << std::strerror(error) << std::endl;
+            return 1;
+        }
+        // 套接字文件已限制为所有者可访问；再按连接凭据确认，拒绝其他用户的进程
+        if (!bergamot_plugin::daemonPeerIsOwner(fd)) {
+            std::cerr << "Rejected connection from another user" << std::endl;
+            close(fd);
+            continue;
+        }
+        std::thread(serve, fd).detach();
+    }
+}
+
+#else
+
+int main() {
+    std::cerr << "bergamot-daemon is not supported on this platform" << std::endl;
+    return 1;
+}
+
+#endif
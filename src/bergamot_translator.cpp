@@ -3,10 +3,20 @@
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <cstddef>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <climits>
+#include <atomic>
+#include <sys/stat.h>
+#include <future>
+#include <deque>
+#include <condition_variable>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 
 // Bergamot translator includes
 #include "translator/byte_array_util.h"
@@ -17,8 +27,49 @@
 #include "translator/utils.h"
 #include "compact_lang_det.h"
 
+#include "cpu_features.h"
+#include "model_bundle.h"
+#include "weight_cache.h"
+#include "worker_pool.h"
+#include "file_pipeline.h"
+#include "result_cache.h"
+#include "inflight_requests.h"
+#include "translation_session.h"
+#include "passthrough_filter.h"
+#include "daemon_client.h"
+#include "daemon_protocol.h"
+#include "repetition_guard.h"
+#include "process_memory.h"
+#include "idle_trim.h"
+#include "request_trace.h"
+#include "fnv_hash.h"
+
 using namespace marian::bergamot;
 
+// 已加载的模型
+// BlockingService 模式下只有一个实例；线程池模式下每个服务副本（每个 NUMA 节点一个）
+// 各持有一个实例，因为 TranslationModel 的后端数量与所属服务的工作线程数绑定。
+struct ModelEntry {
+    std::vector<std::shared_ptr<TranslationModel>> replicas;
+    uint64_t identity = 0;  // 模型内容标识：同一份模型（配置、权重、词表）重新加载后不变，用于结果缓存
+    bool hasCosts = true;   // 解码时是否计算路径得分（skip-cost 时为 false，质量分数不可用）
+
+    // 交给 bergamot 的内存（字节，所有副本之和），见 bergamot_get_memory_stats
+    size_t modelBytes = 0;
+    size_t vocabBytes = 0;      // 词表由各副本共享，只计一份
+    size_t shortlistBytes = 0;
+    size_t otherBytes = 0;
+    size_t workspaceBytes = 0;
+    size_t workers = 0;
+
+    // 重新构造模型实例所需的配置与内存来源（见 trimMemory）；
+    // reloadMemory 同时给出重新读入内容的标识，内容未变时与 identity 相同
+    std::shared_ptr<marian::Options> options;
+    std::function<MemoryBundle(uint64_t& identity)> reloadMemory;
+    // 是否翻译过：工作线程的计算图与工作区在第一次翻译时才按需创建
+    mutable std::atomic<bool> used{false};
+};
+
 // 全局状态
 // macOS: marian/bergamot destructors can throw during shutdown, which triggers
 // std::terminate (destructors are noexcept by default) and aborts the app.
@@ -26,10 +77,10 @@ using namespace marian::bergamot;
 // Workaround: keep the model cache alive until process exit by allocating it on
 // the heap on macOS, so its destructor is never run.
 #if defined(__APPLE__) && !defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
-static auto* model_cache = new std::unordered_map<std::string, std::shared_ptr<TranslationModel>>();
+static auto* model_cache = new std::unordered_map<std::string, std::shared_ptr<ModelEntry>>();
 #define MODEL_CACHE (*model_cache)
 #else
-static std::unordered_map<std::string, std::shared_ptr<TranslationModel>> model_cache;
+static std::unordered_map<std::string, std::shared_ptr<ModelEntry>> model_cache;
 #define MODEL_CACHE model_cache
 #endif
 
@@ -39,23 +90,401 @@ static std::unordered_map<std::string, std::shared_ptr<TranslationModel>> model_
 // triggers std::terminate from a destructor and aborts the app.
 //
 // Keeping the service alive until process exit avoids invoking that destructor.
-static BlockingService* global_service = nullptr;
+// 由 shared_ptr 持有（删除器为空操作）：进行中的请求通过 ServiceHandle 持有引用，
+// 重新配置或 cleanup 期间不会失效
+static std::shared_ptr<BlockingService> global_service;
 static std::mutex service_mutex;
 static std::mutex translation_mutex;
 
+// 服务配置（bergamot_configure_service），由 service_mutex 保护
+struct ServiceSettings {
+    size_t numWorkers = 0;      // 0: 在调用线程上用 BlockingService 同步翻译
+    size_t cacheSize = 256;
+    std::vector<int> cpus;      // 工作线程允许运行的 CPU，空表示不限制
+    bool numaReplicas = false;  // 每个 NUMA 节点一个服务副本
+    size_t preprocessThreads = 0;
+};
+static ServiceSettings service_settings;
+
+// 线程池模式下的服务副本；工作线程在构造时绑定到 cpus。
+// 与 global_service 相同，macOS 上不销毁（见上方说明）；其他平台在最后一个引用
+// （服务表或进行中请求的 ServiceHandle）释放时销毁。
+struct ServiceReplica {
+    std::shared_ptr<AsyncService> service;
+    std::vector<int> cpus;
+    size_t numWorkers;
+};
+static std::vector<ServiceReplica> service_replicas;
+static std::atomic<size_t> next_replica{0};
+
+// BlockingService 模式下等待翻译的请求（见 translateBlocking），由 blocking_queue_mutex 保护
+struct BlockingJob {
+    std::shared_ptr<BlockingService> service;
+    std::shared_ptr<TranslationModel> model;
+    std::vector<std::string> inputs;
+    size_t count = 0;   // 输入条数；options 可能是只增不减的复用数组，只取前 count 项
+    const std::vector<ResponseOptions>* options;
+    std::vector<Response> responses;
+    std::exception_ptr error;
+    bool finished = false;
+    uint64_t traceRequest = 0;  // 追踪中的请求编号（bergamot_set_tracing）
+    int64_t queuedAt = 0;
+};
+static std::mutex blocking_queue_mutex;
+static std::condition_variable blocking_queue_cv;
+static std::deque<BlockingJob*> blocking_queue;
+static bool blocking_leader = false;
+
+// 连续重复的折叠上限（bergamot_set_repetition_limit），0 表示关闭（默认）：折叠会改写文本，需显式开启
+static std::atomic<size_t> repetition_limit{0};
+
+// 内存回收时结果缓存保留的条目数（bergamot_set_idle_trim）
+static std::atomic<size_t> trim_cache_entries{0};
+
+// bergamot_set_tracing 未指定容量时环形缓冲区的区间数
+static const size_t kDefaultTraceCapacity = 65536;
+
+// 不需翻译内容的旁路（bergamot_set_passthrough），BERGAMOT_PASSTHROUGH_* 按位组合；默认关闭
+static std::atomic<int> passthrough_flags{0};
+
+// 线程池模式下的预处理线程（断句与子词编码），为空表示在调用线程上处理；
+// 进行中的请求同样持有引用，销毁（执行完排队任务）发生在最后一个请求结束之后
+static std::shared_ptr<bergamot_plugin::TaskPool> preprocess_pool;
+
+// 词表内存池：按规范化路径共享 .spm 词表字节。
+// constant.dart 中很多语言对复用同一个词表文件（例如 en->zh 复用 vocab.zhen.spm），
+// 枢轴翻译的两个模型也常常共用英文侧词表；这里保证同一文件只读取、只驻留一份。
+// 使用 weak_ptr：最后一个引用它的模型释放后，词表内存随之释放。
+// 由 vocab_registry_mutex 保护（替换模型时在 service_mutex 之外构造新模型）。
+static std::unordered_map<std::string, std::weak_ptr<AlignedMemory>> vocab_registry;
+static std::mutex vocab_registry_mutex;
+
+// 每次销毁服务时递增，由 service_mutex 保护：在锁外构造的模型只能用于构造时的服务
+static uint64_t service_generation = 0;
+// 串行化模型替换，避免同时在后台构造多份新模型
+static std::mutex model_replace_mutex;
+
 // C++ 核心实现函数
 namespace {
+    // 调用者需持有 service_mutex
+    void createServiceReplicas() {
+        std::vector<std::vector<int>> groups;
+        if (service_settings.numaReplicas) {
+            for (auto& node : bergamot_plugin::numaNodeCpus()) {
+                std::vector<int> cpus;
+                for (int cpu : node) {
+                    if (service_settings.cpus.empty() ||
+                        std::find(service_settings.cpus.begin(), service_settings.cpus.end(), cpu) != service_settings.cpus.end()) {
+                        cpus.push_back(cpu);
+                    }
+                }
+                if (!cpus.empty()) {
+                    groups.push_back(std::move(cpus));
+                }
+            }
+        }
+        if (groups.empty()) {
+            groups.push_back(service_settings.cpus);
+        }
+
+        size_t perReplica = std::max<size_t>(1, service_settings.numWorkers / groups.size());
+        for (auto& cpus : groups) {
+            AsyncService::Config asyncConfig;
+            asyncConfig.numWorkers = perReplica;
+            asyncConfig.cacheSize = service_settings.cacheSize;
+            asyncConfig.logger.level = "off";
+
+            // 工作线程继承构造期间调用线程的亲和性掩码
+            bergamot_plugin::ScopedAffinity affinity(cpus);
+#if defined(__APPLE__) && !defined(__IPHONE_OS_VERSION_MIN_REQUIRED)
+            std::shared_ptr<AsyncService> service(new AsyncService(asyncConfig), [](AsyncService*) {});
+#else
+            std::shared_ptr<AsyncService> service(new AsyncService(asyncConfig));
+#endif
+            service_replicas.push_back(ServiceReplica{std::move(service), std::move(cpus), perReplica});
+        }
+    }
+
+    // 调用者需持有 service_mutex
+    // 只释放全局引用：进行中的请求仍持有各自的 ServiceHandle，服务与预处理线程在其结束后才销毁
+    void destroyServices() {
+        preprocess_pool.reset();
+
+        // Do not delete global_service (see note above); just drop references.
+        global_service.reset();
+
+        service_replicas.clear();
+        ++service_generation;
+    }
+
     void initializeService() {
         std::lock_guard<std::mutex> lock(service_mutex);
         
-        if (global_service == nullptr) {
-            BlockingService::Config blockingConfig;
-            blockingConfig.cacheSize = 256;
-            blockingConfig.logger.level = "off";
-            global_service = new BlockingService(blockingConfig);
+        if (global_service == nullptr && service_replicas.empty()) {
+            if (service_settings.numWorkers == 0) {
+                BlockingService::Config blockingConfig;
+                blockingConfig.cacheSize = service_settings.cacheSize;
+                blockingConfig.logger.level = "off";
+                global_service.reset(new BlockingService(blockingConfig), [](BlockingService*) {});
+            } else {
+                createServiceReplicas();
+                if (service_settings.preprocessThreads > 0) {
+                    // 队列长度有上限：预处理领先解码太多只会占用内存
+                    preprocess_pool.reset(new bergamot_plugin::TaskPool(service_settings.preprocessThreads,
+                                                                       4 * service_settings.preprocessThreads));
+                }
+            }
+        }
+    }
+
+    void configureService(const ServiceSettings& settings) {
+        std::lock_guard<std::mutex> lock(service_mutex);
+
+        // 模型实例与服务的工作线程数绑定，必须在加载模型之前配置
+        if (!MODEL_CACHE.empty()) {
+            throw std::runtime_error("Service must be configured before any model is loaded");
         }
+
+        destroyServices();
+        service_settings = settings;
     }
     
+    std::string canonicalPath(const std::string& path) {
+#if _WIN32
+        char resolved[_MAX_PATH];
+        if (_fullpath(resolved, path.c_str(), _MAX_PATH) != nullptr) {
+            return std::string(resolved);
+        }
+#else
+        char resolved[PATH_MAX];
+        if (realpath(path.c_str(), resolved) != nullptr) {
+            return std::string(resolved);
+        }
+#endif
+        return path;
+    }
+
+    // key: 文件词表为规范化路径，模型包中的词表为内容哈希
+    template <typename Loader>
+    std::shared_ptr<AlignedMemory> internVocab(const std::string& key, Loader load) {
+        std::lock_guard<std::mutex> lock(vocab_registry_mutex);
+        auto it = vocab_registry.find(key);
+        if (it != vocab_registry.end()) {
+            if (auto shared = it->second.lock()) {
+                return shared;
+            }
+        }
+
+        auto memory = std::make_shared<AlignedMemory>(load());
+        vocab_registry[key] = memory;
+        return memory;
+    }
+
+    void pruneVocabRegistry() {
+        std::lock_guard<std::mutex> lock(vocab_registry_mutex);
+        for (auto it = vocab_registry.begin(); it != vocab_registry.end();) {
+            if (it->second.expired()) {
+                it = vocab_registry.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // 等价于 getMemoryBundleFromConfig，但词表通过 internVocab 在模型之间共享
+    MemoryBundle buildMemoryBundle(const std::shared_ptr<marian::Options>& options) {
+        MemoryBundle memory;
+        memory.model = bergamot_plugin::preparedModelMemory(
+            options->get<std::vector<std::string>>("models").front(), getModelMemoryFromConfig(options));
+        memory.shortlist = getShortlistMemoryFromConfig(options);
+        for (const auto& path : options->get<std::vector<std::string>>("vocabs")) {
+            std::string canonical = canonicalPath(path);
+            // 与 getVocabsMemoryFromConfig 相同的对齐方式
+            memory.vocabs.push_back(internVocab(canonical, [&] { return loadFileToMemory(canonical, 64); }));
+        }
+        memory.ssplitPrefixFile = getSsplitPrefixFileMemoryFromConfig(options);
+        memory.qualityEstimatorMemory = getQualityEstimatorModel(options);
+        pruneVocabRegistry();
+        return memory;
+    }
+
+    // 模型包加载时作为配置基底的默认选项，只在第一次使用时解析一次
+    const marian::Options& bundleDefaultOptions() {
+        static std::shared_ptr<marian::Options> defaults = parseOptionsFromString("quiet: true\n", false, "");
+        return *defaults;
+    }
+
+    // 从模型包构造 MemoryBundle：映射整个文件，各段从映射区拷出后即释放对应的映射页
+    MemoryBundle buildMemoryBundle(const bergamot_plugin::ModelBundle& bundle, const std::string& path) {
+        using bergamot_plugin::BundleSectionType;
+
+        MemoryBundle memory;
+        for (const auto& section : bundle.sections()) {
+            switch ((BundleSectionType)section.type) {
+                case BundleSectionType::Model:
+                    memory.model = bergamot_plugin::preparedModelMemory(path, bundle.copySection(section));
+                    break;
+                case BundleSectionType::Shortlist:
+                    memory.shortlist = bundle.copySection(section);
+                    break;
+                case BundleSectionType::Vocab: {
+                    std::string vocabKey = "bundle:" + std::to_string(section.checksum) + ":" + std::to_string(section.size);
+                    memory.vocabs.push_back(internVocab(vocabKey, [&] { return bundle.copySection(section); }));
+                    break;
+                }
+                case BundleSectionType::SsplitPrefix:
+                    memory.ssplitPrefixFile = bundle.copySection(section);
+                    break;
+                case BundleSectionType::QualityEstimator:
+                    memory.qualityEstimatorMemory = bundle.copySection(section);
+                    break;
+                default:
+                    break;
+            }
+        }
+        pruneVocabRegistry();
+        return memory;
+    }
+
+    // 调用者需持有 service_mutex
+    // 各服务副本的工作线程数；BlockingService 模式下为空
+    std::vector<size_t> replicaWorkers() {
+        std::vector<size_t> workers;
+        for (const auto& replica : service_replicas) {
+            workers.push_back(replica.numWorkers);
+        }
+        return workers;
+    }
+
+    // makeMemory 每次调用返回一份新的 MemoryBundle（每个副本各自持有）
+    // workers 为 replicaWorkers() 的结果：每个服务副本构造一个实例
+    template <typename MakeMemory>
+    std::shared_ptr<ModelEntry> createModelEntry(const std::shared_ptr<marian::Options>& options, MakeMemory makeMemory,
+                                                 const std::vector<size_t>& workers) {
+        auto entry = std::make_shared<ModelEntry>();
+        entry->hasCosts = !options->get<bool>("skip-cost", false);
+
+        // 每个工作线程在模型上各有一个计算图，按 workspace（MB）预留工作区
+        size_t workspaceBytes = (size_t)std::max(options->get<int>("workspace", 0), 0) << 20;
+        auto measured = [&](size_t replicaWorkers) {
+            MemoryBundle memory = makeMemory();
+            entry->modelBytes += memory.model.size();
+            entry->shortlistBytes += memory.shortlist.size();
+            entry->otherBytes += memory.ssplitPrefixFile.size() + memory.qualityEstimatorMemory.size();
+            if (entry->replicas.empty()) {
+                for (const auto& vocab : memory.vocabs) {
+                    entry->vocabBytes += vocab->size();
+                }
+            }
+            entry->workspaceBytes += workspaceBytes * replicaWorkers;
+            entry->workers += replicaWorkers;
+            return memory;
+        };
+
+        if (workers.empty()) {
+            entry->replicas.push_back(std::make_shared<TranslationModel>(options, measured(1)));
+        } else {
+            for (size_t replicaWorkers : workers) {
+                entry->replicas.push_back(std::make_shared<TranslationModel>(options, measured(replicaWorkers),
+                                                                            replicaWorkers));
+            }
+        }
+        return entry;
+    }
+
+    // 需要唯一标识时（内容可能在读取期间变化、或替换后内容无法区分）混入的序号
+    uint64_t uniqueIdentity(uint64_t identity) {
+        static std::atomic<uint64_t> serial{0};
+        uint64_t value = ++serial;
+        return bergamot_plugin::fnv1a64(&value, sizeof(value), identity);
+    }
+
+    // 按配置加载的模型标识：配置文本、模型路径，以及配置引用的各文件的大小与修改时间，
+    // 文件被更新后标识随之改变。shortlist 等列表中不是文件的参数 stat 失败，直接跳过
+    uint64_t configIdentity(const std::string& cfg, const std::string& modelPath, const marian::Options& options) {
+        uint64_t identity = bergamot_plugin::fnv1a64(modelPath.data(), modelPath.size(),
+                                                     bergamot_plugin::fnv1a64(cfg.data(), cfg.size()));
+        auto addFile = [&identity](const std::string& path) {
+            struct stat st;
+            if (!path.empty() && stat(path.c_str(), &st) == 0) {
+                int64_t stamp[2] = {(int64_t)st.st_size, (int64_t)st.st_mtime};
+                identity = bergamot_plugin::fnv1a64(stamp, sizeof(stamp), identity);
+            }
+        };
+        try {
+            for (const char* key : {"models", "vocabs", "shortlist"}) {
+                if (options.has(key)) {
+                    for (const auto& path : options.get<std::vector<std::string>>(key)) {
+                        addFile(path);
+                    }
+                }
+            }
+            for (const char* key : {"ssplit-prefix-file", "quality"}) {
+                if (options.has(key)) {
+                    addFile(options.get<std::string>(key));
+                }
+            }
+        } catch (const std::exception &) {
+            // 类型不符的配置项由加载过程报告，这里只少取一部分文件信息
+        }
+        return identity;
+    }
+
+    // 读取前后各取一次标识，不一致说明文件在读取期间被更新，换用唯一标识
+    MemoryBundle reloadFromConfig(const std::shared_ptr<marian::Options>& options, const std::string& cfg,
+                                  const std::string& modelPath, uint64_t& identity) {
+        identity = configIdentity(cfg, modelPath, *options);
+        MemoryBundle memory = buildMemoryBundle(options);
+        if (configIdentity(cfg, modelPath, *options) != identity) {
+            identity = uniqueIdentity(identity);
+        }
+        return memory;
+    }
+
+    // 按 YAML 配置构造模型（不加入缓存）
+    std::shared_ptr<ModelEntry> buildModelFromConfig(const std::string& cfg, const std::vector<size_t>& workers) {
+        auto validate = false;  // Temporarily disable validation to avoid YAML node iterator error
+        auto pathsDir = "";
+
+        // 解析配置
+        std::shared_ptr<marian::Options> options = parseOptionsFromString(cfg, validate, pathsDir);
+
+        // 创建模型（词表内存与其他已加载模型共享）
+        std::string modelPath = canonicalPath(options->get<std::vector<std::string>>("models").front());
+        uint64_t identity = 0;
+        auto entry = createModelEntry(options, [&] { return reloadFromConfig(options, cfg, modelPath, identity); }, workers);
+        entry->options = options;
+        entry->reloadMemory = [options, cfg, modelPath](uint64_t& reloaded) {
+            return reloadFromConfig(options, cfg, modelPath, reloaded);
+        };
+        entry->identity = identity;
+        return entry;
+    }
+
+    // 以各段校验和为标识，与包文件所在路径无关
+    uint64_t bundleIdentity(const bergamot_plugin::ModelBundle& bundle) {
+        uint64_t identity = bergamot_plugin::kFnvOffsetBasis;
+        for (const auto& section : bundle.sections()) {
+            identity = bergamot_plugin::fnv1a64(&section.checksum, sizeof(section.checksum), identity);
+        }
+        return identity;
+    }
+
+    // 按模型包构造模型（不加入缓存）
+    std::shared_ptr<ModelEntry> buildModelFromBundle(const std::string& path, const std::vector<size_t>& workers) {
+        bergamot_plugin::ModelBundle bundle(path);
+        std::shared_ptr<marian::Options> options = bundle.options(bundleDefaultOptions());
+        auto entry = createModelEntry(options, [&] { return buildMemoryBundle(bundle, path); }, workers);
+        entry->options = options;
+        entry->reloadMemory = [path](uint64_t& identity) {
+            bergamot_plugin::ModelBundle reopened(path);
+            identity = bundleIdentity(reopened);
+            return buildMemoryBundle(reopened, path);
+        };
+        entry->identity = bundleIdentity(bundle);
+        return entry;
+    }
+
     void loadModelIntoCache(const std::string& cfg, const std::string& key) {
         std::lock_guard<std::mutex> lock(service_mutex);
         
@@ -65,14 +494,7 @@ namespace {
         }
         
         try {
-            auto validate = false;  // Temporarily disable validation to avoid YAML node iterator error
-            auto pathsDir = "";
-            
-            // 解析配置
-            std::shared_ptr<marian::Options> options = parseOptionsFromString(cfg, validate, pathsDir);
-            
-            // 创建模型
-            MODEL_CACHE[key] = std::make_shared<TranslationModel>(options);
+            MODEL_CACHE[key] = buildModelFromConfig(cfg, replicaWorkers());
         } catch (const std::exception &e) {
             // 重新抛出异常，让调用者处理
             throw std::runtime_error("Failed to load model " + key + ": " + e.what());
@@ -82,81 +504,1012 @@ namespace {
         }
     }
     
-    std::vector<std::string> translateMultiple(std::vector<std::string> &&inputs, const char *key) {
-        initializeService();
-        
-        std::string key_str(key);
-        
-        // 检查模型是否已加载
-        if (MODEL_CACHE.find(key_str) == MODEL_CACHE.end()) {
-            throw std::runtime_error("Model not loaded: " + key_str);
+    void loadModelBundleIntoCache(const std::string& path, const std::string& key) {
+        std::lock_guard<std::mutex> lock(service_mutex);
+
+        if (MODEL_CACHE.find(key) != MODEL_CACHE.end()) {
+            return;
         }
-        
-        std::shared_ptr<TranslationModel> model = MODEL_CACHE[key_str];
-        
+
+        try {
+            MODEL_CACHE[key] = buildModelFromBundle(path, replicaWorkers());
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Failed to load model bundle " + key + ": " + e.what());
+        } catch (...) {
+            throw std::runtime_error("Failed to load model bundle " + key + ": Unknown error");
+        }
+    }
+
+    // 替换 key 下的模型（key 不存在时等同于加载），不中断翻译：
+    // 新模型在 service_mutex 之外构造，期间请求照常使用旧模型；构造完成后在锁内换入。
+    // 进行中的请求持有旧模型的引用并在旧实例上完成，最后一个引用释放时旧模型随之释放。
+    // contentIdentity 为 false 时（按配置加载，标识只包含路径、配置文本与文件的大小和修改时间，
+    // 不能完全反映内容），新模型即使标识相同也换用新标识，避免结果缓存返回旧模型的译文。
+    template <typename Build>
+    void replaceModelInCache(const std::string& key, bool contentIdentity, Build build) {
+        std::lock_guard<std::mutex> replace_lock(model_replace_mutex);
+
+        std::vector<size_t> workers;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(service_mutex);
+            workers = replicaWorkers();
+            generation = service_generation;
+        }
+
+        std::shared_ptr<ModelEntry> fresh = build(workers);
+        std::shared_ptr<ModelEntry> old;
+        {
+            std::lock_guard<std::mutex> lock(service_mutex);
+            if (generation != service_generation) {
+                throw std::runtime_error("Service was reconfigured while replacing model " + key);
+            }
+            std::shared_ptr<ModelEntry>& slot = MODEL_CACHE[key];
+            if (!contentIdentity && slot != nullptr && slot->identity == fresh->identity) {
+                fresh->identity = uniqueIdentity(fresh->identity);
+            }
+            old = std::move(slot);
+            slot = fresh;
+        }
+        // 没有进行中的请求时，旧模型在这里（锁外）释放
+        old.reset();
+        pruneVocabRegistry();
+    }
+
+    struct ModelMemoryUsage {
+        std::string key;
+        std::shared_ptr<ModelEntry> entry;
+    };
+
+    // 已加载模型（按键排序）与去重后的词表总量
+    std::vector<ModelMemoryUsage> modelMemoryUsage(size_t& vocabBytes) {
+        std::lock_guard<std::mutex> lock(service_mutex);
+        std::vector<ModelMemoryUsage> usage;
+        for (const auto& item : MODEL_CACHE) {
+            usage.push_back(ModelMemoryUsage{item.first, item.second});
+        }
+        std::sort(usage.begin(), usage.end(),
+                  [](const ModelMemoryUsage& a, const ModelMemoryUsage& b) { return a.key < b.key; });
+
+        vocabBytes = 0;
+        std::lock_guard<std::mutex> vocab_lock(vocab_registry_mutex);
+        for (const auto& item : vocab_registry) {
+            if (auto vocab = item.second.lock()) {
+                vocabBytes += vocab->size();
+            }
+        }
+        return usage;
+    }
+
+    std::shared_ptr<ModelEntry> findModel(const std::string& key) {
+        std::lock_guard<std::mutex> lock(service_mutex);
+        auto it = MODEL_CACHE.find(key);
+        return it == MODEL_CACHE.end() ? nullptr : it->second;
+    }
+
+    // 客户端模式下模型在守护进程中，由守护进程检查
+    bool modelAvailable(const std::string& key) {
+        return bergamot_plugin::daemonConnected() || findModel(key) != nullptr;
+    }
+
+    // 调用者需持有 service_mutex
+    // 优先选择调用线程所在 NUMA 节点的副本，无法判断时轮询
+    size_t pickReplica() {
+        if (service_replicas.size() > 1) {
+            int cpu = bergamot_plugin::currentCpu();
+            for (size_t i = 0; i < service_replicas.size(); ++i) {
+                const auto& cpus = service_replicas[i].cpus;
+                if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+                    return i;
+                }
+            }
+        }
+        return next_replica.fetch_add(1, std::memory_order_relaxed) % service_replicas.size();
+    }
+
+    // 线程池模式：逐条提交给 AsyncService，等待全部回调完成
+    // extract 在工作线程的回调中执行，只保留调用者需要的部分，Response 随即释放
+    // preprocess 非空时由预处理线程提交：AsyncService::translate 在提交线程上完成断句与子词编码，
+    // 这样调用线程不再串行处理文本，多个请求的预处理彼此并行，并与解码重叠
+    template <typename Result, typename Submit, typename Extract>
+    std::vector<Result> awaitResults(size_t count, bergamot_plugin::TaskPool* preprocess, Submit submit, Extract extract) {
+        // 回调可能在本函数因异常提前返回后才执行，promise 由回调共同持有
+        auto promises = std::make_shared<std::vector<std::promise<Result>>>(count);
+        std::vector<std::future<Result>> futures;
+        futures.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            futures.push_back((*promises)[i].get_future());
+        }
+        // 提交时完成断句与子词编码（bergamot AsyncService::translate），之后等待组批与解码
+        uint64_t traceRequest = bergamot_plugin::currentTraceRequest();
+        std::unique_ptr<bergamot_plugin::TraceSpan> segmentation;
+        if (preprocess == nullptr) {
+            segmentation.reset(new bergamot_plugin::TraceSpan("segmentation", (int64_t)count));
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto run = [promises, i, extract, &submit]() {
+                try {
+                    submit(i, [promises, i, extract](Response &&response) {
+                        (*promises)[i].set_value(extract(std::move(response)));
+                    });
+                } catch (...) {
+                    try {
+                        (*promises)[i].set_exception(std::current_exception());
+                    } catch (const std::future_error &) {
+                        // 回调已经给出了结果
+                    }
+                }
+            };
+            if (preprocess != nullptr) {
+                preprocess->submit([run, traceRequest]() {
+                    bergamot_plugin::TraceAdopt adopt(traceRequest);
+                    bergamot_plugin::TraceSpan span("segmentation", 1);
+                    run();
+                });
+            } else {
+                run();
+            }
+        }
+        segmentation.reset();
+
+        // 排队中的任务引用了 submit 及其捕获的局部变量，全部完成后才能返回（包括出错时）
+        {
+            bergamot_plugin::TraceSpan decode("decode", (int64_t)count);
+            for (auto &future: futures) {
+                future.wait();
+            }
+        }
+        std::vector<Result> results;
+        results.reserve(count);
+        for (auto &future: futures) {
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
+    template <typename Result, typename Extract>
+    std::vector<Result> extractAll(std::vector<Response> &&responses, Extract extract) {
+        bergamot_plugin::TraceSpan span("response_build", (int64_t)responses.size());
+        std::vector<Result> results;
+        results.reserve(responses.size());
+        for (auto &response: responses) {
+            results.push_back(extract(std::move(response)));
+        }
+        return results;
+    }
+
+    // 请求期间持有所用服务的引用，重新配置或 cleanup 不会在请求中途销毁它们
+    struct ServiceHandle {
+        std::shared_ptr<BlockingService> blocking;
+        std::shared_ptr<AsyncService> pool;     // 为空表示 BlockingService 模式
+        size_t replica = 0;
+        std::shared_ptr<bergamot_plugin::TaskPool> preprocess;
+    };
+
+    ServiceHandle acquireService() {
+        std::lock_guard<std::mutex> lock(service_mutex);
+        ServiceHandle handle;
+        if (service_replicas.empty()) {
+            if (global_service == nullptr) {
+                throw std::runtime_error("Service not initialized");
+            }
+            handle.blocking = global_service;
+            return handle;
+        }
+        handle.replica = pickReplica();
+        handle.pool = service_replicas[handle.replica].service;
+        handle.preprocess = preprocess_pool;
+        return handle;
+    }
+
+    // 取出队首模型的全部排队请求，合并为一次 translateMultiple（本轮开始后到达的请求等下一轮）
+    // 调用者需持有 blocking_queue_mutex 的锁（lock），执行期间释放
+    void runBlockingRound(std::unique_lock<std::mutex>& lock) {
+        std::vector<BlockingJob*> jobs;
+        std::shared_ptr<BlockingService> service = blocking_queue.front()->service;
+        std::shared_ptr<TranslationModel> model = blocking_queue.front()->model;
+        for (auto it = blocking_queue.begin(); it != blocking_queue.end();) {
+            if ((*it)->model == model && (*it)->service == service) {
+                jobs.push_back(*it);
+                it = blocking_queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        lock.unlock();
+
+        int64_t roundBegin = bergamot_plugin::traceNow();
+        // 多个请求合并时保留各自的输入，本轮失败后逐个重试
+        bool merged = jobs.size() > 1;
+        std::vector<std::string> inputs;
         std::vector<ResponseOptions> responseOptions;
-        responseOptions.reserve(inputs.size());
-        for (size_t i = 0; i < inputs.size(); ++i) {
+        for (BlockingJob* job : jobs) {
+            if (merged) {
+                inputs.insert(inputs.end(), job->inputs.begin(), job->inputs.end());
+            } else {
+                std::move(job->inputs.begin(), job->inputs.end(), std::back_inserter(inputs));
+            }
+            responseOptions.insert(responseOptions.end(), job->options->begin(), job->options->begin() + job->count);
+        }
+
+        auto decode = [&service, &model](std::vector<std::string> &&texts, const std::vector<ResponseOptions>& options) {
+            size_t count = texts.size();
+            std::lock_guard<std::mutex> translation_lock(translation_mutex);
+            std::vector<Response> responses = service->translateMultiple(model, std::move(texts), options);
+            if (responses.size() != count) {
+                throw std::runtime_error("Translation count does not match input");
+            }
+            return responses;
+        };
+
+        std::vector<Response> responses;
+        std::exception_ptr error;
+        int64_t decodeBegin = bergamot_plugin::traceNow();
+        size_t inputCount = inputs.size();
+        try {
+            responses = decode(std::move(inputs), responseOptions);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        int64_t decodeEnd = bergamot_plugin::traceNow();
+
+        // 每个被合并的请求都记录：排队、合并组批（count 为合并的请求数）、解码（count 为本轮输入总数，
+        // bergamot 在其中完成断句、子词编码、按长度组批与逐批解码）
+        for (BlockingJob* job : jobs) {
+            bergamot_plugin::recordSpan(job->traceRequest, "queue_wait", job->queuedAt, roundBegin);
+            bergamot_plugin::recordSpan(job->traceRequest, "batch_merge", roundBegin, decodeBegin, (int64_t)jobs.size());
+            bergamot_plugin::recordSpan(job->traceRequest, "decode", decodeBegin, decodeEnd, (int64_t)inputCount);
+        }
+
+        // 各请求的结果在持锁前写好，等待者只在持锁时读取 finished
+        size_t next = 0;
+        for (BlockingJob* job : jobs) {
+            if (!error) {
+                for (size_t i = 0; i < job->count; ++i) {
+                    job->responses.push_back(std::move(responses[next++]));
+                }
+            } else if (!merged) {
+                job->error = error;
+            } else {
+                // 合并的一轮失败时逐个重试，某个调用方的坏输入不会让其他调用方一起失败
+                int64_t retryBegin = bergamot_plugin::traceNow();
+                try {
+                    std::vector<ResponseOptions> options(job->options->begin(), job->options->begin() + job->count);
+                    job->responses = decode(std::move(job->inputs), options);
+                } catch (...) {
+                    job->error = std::current_exception();
+                }
+                bergamot_plugin::recordSpan(job->traceRequest, "decode_retry", retryBegin, bergamot_plugin::traceNow(),
+                                            (int64_t)job->count);
+            }
+        }
+
+        lock.lock();
+        for (BlockingJob* job : jobs) {
+            job->finished = true;
+        }
+    }
+
+    // BlockingService 模式的请求合并（request coalescing）
+    // 解码器忙时到达的请求排队；当前一轮结束后，同一模型的全部排队请求合并成一次调用，
+    // 由 bergamot 按长度重新组批。短句不必再等同一请求里的长句，多个调用方的句子也能填满同一批次。
+    // 合并只发生在两轮之间：已开始的一轮不会接纳新到达的句子，这不是解码步级别的连续批处理。
+    // 没有单独的调度线程：空闲时由任一等待者执行下一轮。
+    std::vector<Response> translateBlocking(const std::shared_ptr<BlockingService>& service,
+                                            const std::shared_ptr<TranslationModel>& model, std::vector<std::string> &&inputs,
+                                            const std::vector<ResponseOptions>& responseOptions) {
+        BlockingJob job;
+        job.service = service;
+        job.model = model;
+        job.inputs = std::move(inputs);
+        job.count = job.inputs.size();
+        job.options = &responseOptions;
+        job.traceRequest = bergamot_plugin::currentTraceRequest();
+        if (job.traceRequest != 0) {
+            job.queuedAt = bergamot_plugin::traceNow();
+        }
+
+        std::unique_lock<std::mutex> lock(blocking_queue_mutex);
+        blocking_queue.push_back(&job);
+        while (!job.finished) {
+            if (blocking_leader) {
+                blocking_queue_cv.wait(lock);
+                continue;
+            }
+            blocking_leader = true;
+            runBlockingRound(lock);
+            blocking_leader = false;
+            blocking_queue_cv.notify_all();
+        }
+        lock.unlock();
+
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+        return std::move(job.responses);
+    }
+
+    template <typename Result, typename Extract>
+    std::vector<Result> translateWith(const ModelEntry& model, std::vector<std::string> &&inputs,
+                                      const std::vector<ResponseOptions>& responseOptions, Extract extract) {
+        bergamot_plugin::ActivityScope activity;
+        model.used.store(true, std::memory_order_relaxed);
+        ServiceHandle service = acquireService();
+        if (service.pool == nullptr) {
+            std::vector<Response> responses = translateBlocking(service.blocking, model.replicas.front(), std::move(inputs),
+                                                                responseOptions);
+            return extractAll<Result>(std::move(responses), extract);
+        }
+
+        std::shared_ptr<TranslationModel> instance = model.replicas.at(service.replica);
+        return awaitResults<Result>(inputs.size(), service.preprocess.get(), [&](size_t i, CallbackType callback) {
+            service.pool->translate(instance, std::move(inputs[i]), callback, responseOptions[i]);
+        }, extract);
+    }
+
+    template <typename Result, typename Extract>
+    std::vector<Result> pivotWith(const ModelEntry& first, const ModelEntry& second, std::vector<std::string> &&inputs,
+                                  const std::vector<ResponseOptions>& responseOptions, Extract extract) {
+        bergamot_plugin::ActivityScope activity;
+        first.used.store(true, std::memory_order_relaxed);
+        second.used.store(true, std::memory_order_relaxed);
+        ServiceHandle service = acquireService();
+        if (service.pool == nullptr) {
+            std::vector<Response> responses;
+            {
+                std::unique_ptr<bergamot_plugin::TraceSpan> wait(new bergamot_plugin::TraceSpan("queue_wait"));
+                std::lock_guard<std::mutex> translation_lock(translation_mutex);
+                wait.reset();
+                bergamot_plugin::TraceSpan decode("decode", (int64_t)inputs.size());
+                responses = service.blocking->pivotMultiple(first.replicas.front(), second.replicas.front(), std::move(inputs), responseOptions);
+            }
+            return extractAll<Result>(std::move(responses), extract);
+        }
+
+        std::shared_ptr<TranslationModel> firstInstance = first.replicas.at(service.replica);
+        std::shared_ptr<TranslationModel> secondInstance = second.replicas.at(service.replica);
+        return awaitResults<Result>(inputs.size(), service.preprocess.get(), [&](size_t i, CallbackType callback) {
+            service.pool->pivot(firstInstance, secondInstance, std::move(inputs[i]), callback, responseOptions[i]);
+        }, extract);
+    }
+
+    // 精简模式：对齐、质量分数、句子映射、HTML 全部关闭，只取译文
+    // 选项表按线程复用，避免每次请求重新分配；
+    // 偶发的超大批次过后收缩回当前大小，免得常驻线程一直占着峰值内存
+    const std::vector<ResponseOptions>& leanResponseOptions(size_t count) {
+        constexpr size_t kRetainedOptions = 4096;
+        thread_local std::vector<ResponseOptions> options;
+        if (options.size() > kRetainedOptions && options.size() > count * 4) {
+            options.resize(std::max(count, kRetainedOptions));
+            options.shrink_to_fit();
+        }
+        if (options.size() < count) {
             ResponseOptions opts;
             opts.HTML = false;
             opts.qualityScores = false;
             opts.alignment = false;
             opts.sentenceMappings = false;
-            responseOptions.emplace_back(opts);
+            options.resize(count, opts);
+        }
+        return options;
+    }
+
+    // 译文直接从 Response 中移出，不再复制
+    std::string takeTargetText(Response &&response) {
+        return std::move(response.target.text);
+    }
+
+    // 先查结果缓存，再与正在解码的相同输入合并，只把剩下的输入交给 translate，再按原顺序合并
+    template <typename Translate>
+    std::vector<std::string> withSharedResults(uint64_t identity, std::vector<std::string> &&inputs, Translate translate) {
+        bool useCache = bergamot_plugin::resultCacheEnabled();
+        std::vector<std::string> results(inputs.size());
+        std::vector<size_t> missIndices;
+        std::vector<std::string> misses;
+        std::vector<std::pair<size_t, std::shared_future<std::string>>> followers;
+        std::unique_ptr<bergamot_plugin::TraceSpan> lookup(new bergamot_plugin::TraceSpan("cache_lookup", (int64_t)inputs.size()));
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (useCache && bergamot_plugin::lookupResult(identity, inputs[i], results[i])) {
+                continue;
+            }
+            std::shared_future<std::string> pending;
+            if (bergamot_plugin::joinFlight(identity, inputs[i], pending)) {
+                missIndices.push_back(i);
+                misses.push_back(inputs[i]);
+            } else {
+                followers.emplace_back(i, std::move(pending));
+            }
+        }
+        lookup.reset();
+
+        if (!misses.empty()) {
+            std::vector<std::string> translations;
+            try {
+                translations = translate(std::move(misses));
+                if (translations.size() != missIndices.size()) {
+                    throw std::runtime_error("Translation count does not match input");
+                }
+            } catch (...) {
+                // 等待同一输入的其他请求也会收到这个错误
+                for (size_t i : missIndices) {
+                    bergamot_plugin::abandonFlight(identity, inputs[i], std::current_exception());
+                }
+                throw;
+            }
+            for (size_t j = 0; j < missIndices.size(); ++j) {
+                size_t i = missIndices[j];
+                if (useCache) {
+                    bergamot_plugin::storeResult(identity, inputs[i], translations[j]);
+                }
+                bergamot_plugin::completeFlight(identity, inputs[i], translations[j]);
+                results[i] = std::move(translations[j]);
+            }
+        }
+
+        // 自己负责的输入全部完成后才等待别人，批内重复与相互等待都不会死锁
+        bergamot_plugin::TraceSpan wait("coalesced_wait", (int64_t)followers.size());
+        for (auto &follower: followers) {
+            results[follower.first] = follower.second.get();
+        }
+        return results;
+    }
+
+    // 折叠退化的重复：输入侧只折叠重复词组以缩短解码长度（output 为 false），
+    // 输出侧另外截断同一字母的长串，去掉解码器的重复循环
+    void collapseRepeatedText(std::vector<std::string>& texts, bool output) {
+        size_t limit = repetition_limit.load(std::memory_order_relaxed);
+        if (limit == 0) {
+            return;
+        }
+        for (auto &text: texts) {
+            text = bergamot_plugin::collapseRepeats(text, limit, output);
+        }
+    }
+
+    // 整段不需翻译的输入直接原样返回；句中的 URL、邮箱、哈希替换为占位符后再交给 translate。
+    // 译文丢失占位符的输入改为按原文再翻译一次
+    template <typename Translate>
+    std::vector<std::string> withPassthrough(std::vector<std::string> &&inputs, Translate translate) {
+        int flags = passthrough_flags.load(std::memory_order_relaxed);
+        if (flags == 0) {
+            return translate(std::move(inputs));
+        }
+
+        std::vector<std::string> results(inputs.size());
+        std::vector<size_t> indices;
+        std::vector<bergamot_plugin::MaskedText> masks;
+        std::vector<std::string> pending;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if ((flags & BERGAMOT_PASSTHROUGH_SEGMENTS) && bergamot_plugin::isVerbatimText(inputs[i])) {
+                results[i] = std::move(inputs[i]);
+                continue;
+            }
+            indices.push_back(i);
+            if (flags & BERGAMOT_PASSTHROUGH_SPANS) {
+                masks.push_back(bergamot_plugin::maskVerbatimSpans(inputs[i]));
+                pending.push_back(masks.back().text);
+            } else {
+                pending.push_back(std::move(inputs[i]));
+            }
+        }
+        if (pending.empty()) {
+            return results;
+        }
+
+        std::vector<std::string> translations = translate(std::move(pending));
+        if (translations.size() != indices.size()) {
+            throw std::runtime_error("Translation count does not match input");
         }
+        if (masks.empty()) {
+            for (size_t j = 0; j < indices.size(); ++j) {
+                results[indices[j]] = std::move(translations[j]);
+            }
+            return results;
+        }
+
+        std::vector<size_t> retryIndices;
+        std::vector<std::string> retries;
+        for (size_t j = 0; j < indices.size(); ++j) {
+            size_t i = indices[j];
+            if (!bergamot_plugin::restoreVerbatimSpans(masks[j], translations[j], results[i])) {
+                retryIndices.push_back(i);
+                retries.push_back(std::move(inputs[i]));
+            }
+        }
+        if (!retries.empty()) {
+            std::vector<std::string> fallback = translate(std::move(retries));
+            if (fallback.size() != retryIndices.size()) {
+                throw std::runtime_error("Translation count does not match input");
+            }
+            for (size_t j = 0; j < retryIndices.size(); ++j) {
+                results[retryIndices[j]] = std::move(fallback[j]);
+            }
+        }
+        return results;
+    }
+
+    std::vector<std::string> translateMultiple(std::vector<std::string> &&inputs, const char *key, bool html = false) {
+        if (bergamot_plugin::daemonConnected()) {
+            std::vector<std::string> args{key, html ? "html" : ""};
+            args.insert(args.end(), std::make_move_iterator(inputs.begin()), std::make_move_iterator(inputs.end()));
+            return bergamot_plugin::daemonCall(bergamot_plugin::kDaemonTranslate, std::move(args));
+        }
+
+        initializeService();
         
-        std::lock_guard<std::mutex> translation_lock(translation_mutex);
-        std::vector<Response> responses = global_service->translateMultiple(model, std::move(inputs), responseOptions);
+        std::string key_str(key);
         
-        std::vector<std::string> results;
-        results.reserve(responses.size());
-        for (const auto &response: responses) {
-            results.push_back(response.target.text);
+        // 检查模型是否已加载
+        std::shared_ptr<ModelEntry> model = findModel(key_str);
+        if (model == nullptr) {
+            throw std::runtime_error("Model not loaded: " + key_str);
         }
         
-        return results;
+        if (html) {
+            ResponseOptions opts;
+            opts.HTML = true;
+            opts.qualityScores = false;
+            // HTML 模式依靠对齐把标签放回译文
+            opts.alignment = true;
+            opts.sentenceMappings = true;
+            std::vector<ResponseOptions> responseOptions(inputs.size(), opts);
+            return translateWith<std::string>(*model, std::move(inputs), responseOptions, takeTargetText);
+        }
+        
+        return withPassthrough(std::move(inputs), [&](std::vector<std::string> &&texts) {
+            return withSharedResults(model->identity, std::move(texts), [&](std::vector<std::string> &&misses) {
+                collapseRepeatedText(misses, false);
+                const auto& responseOptions = leanResponseOptions(misses.size());
+                auto translations = translateWith<std::string>(*model, std::move(misses), responseOptions, takeTargetText);
+                collapseRepeatedText(translations, true);
+                return translations;
+            });
+        });
     }
     
+    // 未指定时同时翻译的块数：阻塞模式下一块解码、一块读写即可，线程池模式下让每个工作线程都有活干
+    size_t defaultMaxInFlight() {
+        std::lock_guard<std::mutex> lock(service_mutex);
+        return std::max<size_t>(2, service_settings.numWorkers);
+    }
+    
+    // 文件翻译任务的公共部分：检查模型、解析 BergamotFileOptions
+    struct FileJob {
+        std::string key;
+        bool html = false;
+        bergamot_plugin::FilePipelineOptions pipelineOptions;
+        bergamot_plugin::ProgressCallback progress;
+
+        FileJob(const char* modelKey, const BergamotFileOptions* options) : key(modelKey) {
+            initializeService();
+            if (!modelAvailable(key)) {
+                throw std::runtime_error("Model not loaded: " + key);
+            }
+
+            pipelineOptions.maxInFlight = defaultMaxInFlight();
+            if (options == nullptr) {
+                return;
+            }
+            if (options->chunk_bytes > 0) {
+                pipelineOptions.chunkBytes = (size_t)options->chunk_bytes;
+            }
+            if (options->max_in_flight > 0) {
+                pipelineOptions.maxInFlight = (size_t)options->max_in_flight;
+            }
+            html = options->html != 0;
+            if (options->progress != nullptr) {
+                BergamotProgressCallback callback = options->progress;
+                void* userData = options->user_data;
+                progress = [callback, userData](int64_t done, int64_t total) { callback(done, total, userData); };
+            }
+        }
+
+        bergamot_plugin::TranslateBatch translate() const {
+            const std::string& modelKey = key;
+            bool markup = html;
+            uint64_t traceRequest = bergamot_plugin::currentTraceRequest();
+            return [&modelKey, markup, traceRequest](std::vector<std::string> &&inputs) {
+                // 各块在文件流水线的任务线程上翻译
+                bergamot_plugin::TraceAdopt adopt(traceRequest);
+                return translateMultiple(std::move(inputs), modelKey.c_str(), markup);
+            };
+        }
+    };
+    
     std::vector<std::string> pivotMultiple(const char *firstKey, const char *secondKey, std::vector<std::string> &&inputs) {
+        if (bergamot_plugin::daemonConnected()) {
+            std::vector<std::string> args{firstKey, secondKey};
+            args.insert(args.end(), std::make_move_iterator(inputs.begin()), std::make_move_iterator(inputs.end()));
+            return bergamot_plugin::daemonCall(bergamot_plugin::kDaemonPivot, std::move(args));
+        }
+
         initializeService();
         
         std::string first_key_str(firstKey);
         std::string second_key_str(secondKey);
         
         // 检查模型是否已加载
-        if (MODEL_CACHE.find(first_key_str) == MODEL_CACHE.end()) {
+        std::shared_ptr<ModelEntry> firstModel = findModel(first_key_str);
+        if (firstModel == nullptr) {
             throw std::runtime_error("First model not loaded: " + first_key_str);
         }
-        if (MODEL_CACHE.find(second_key_str) == MODEL_CACHE.end()) {
+        std::shared_ptr<ModelEntry> secondModel = findModel(second_key_str);
+        if (secondModel == nullptr) {
             throw std::runtime_error("Second model not loaded: " + second_key_str);
         }
         
-        std::shared_ptr<TranslationModel> firstModel = MODEL_CACHE[first_key_str];
-        std::shared_ptr<TranslationModel> secondModel = MODEL_CACHE[second_key_str];
-        
-        std::vector<ResponseOptions> responseOptions;
-        responseOptions.reserve(inputs.size());
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            ResponseOptions opts;
-            opts.HTML = false;
-            opts.qualityScores = false;
-            opts.alignment = false;
-            opts.sentenceMappings = false;
-            responseOptions.emplace_back(opts);
+        uint64_t identity = bergamot_plugin::fnv1a64(&secondModel->identity, sizeof(uint64_t), firstModel->identity);
+        return withPassthrough(std::move(inputs), [&](std::vector<std::string> &&texts) {
+            return withSharedResults(identity, std::move(texts), [&](std::vector<std::string> &&misses) {
+                collapseRepeatedText(misses, false);
+                const auto& responseOptions = leanResponseOptions(misses.size());
+                auto translations = pivotWith<std::string>(*firstModel, *secondModel, std::move(misses), responseOptions, takeTargetText);
+                collapseRepeatedText(translations, true);
+                return translations;
+            });
+        });
+    }
+    
+    // 一个源语言翻译到多个目标语言：第一跳（源语言 -> 中间语言）只做一次，
+    // 中间译文再并行交给各个第二跳模型。结果按目标优先排列：[target * inputCount + input]
+    std::vector<std::string> pivotFanOut(const char *sourceKey, const std::vector<std::string>& targetKeys,
+                                         std::vector<std::string> &&inputs) {
+        initializeService();
+
+        for (const auto& targetKey : targetKeys) {
+            if (!modelAvailable(targetKey)) {
+                throw std::runtime_error("Target model not loaded: " + targetKey);
+            }
         }
-        
-        std::lock_guard<std::mutex> translation_lock(translation_mutex);
-        std::vector<Response> responses = global_service->pivotMultiple(firstModel, secondModel, std::move(inputs), responseOptions);
-        
+
+        size_t inputCount = inputs.size();
+        std::vector<std::string> intermediate = translateMultiple(std::move(inputs), sourceKey);
+
+        // 最后一个目标在当前线程翻译，其余各起一个任务
+        std::vector<std::future<std::vector<std::string>>> futures;
+        for (size_t t = 0; t + 1 < targetKeys.size(); ++t) {
+            uint64_t traceRequest = bergamot_plugin::currentTraceRequest();
+            futures.push_back(std::async(std::launch::async, [&intermediate, &targetKeys, t, traceRequest]() {
+                bergamot_plugin::TraceAdopt adopt(traceRequest);
+                std::vector<std::string> copy = intermediate;
+                return translateMultiple(std::move(copy), targetKeys[t].c_str());
+            }));
+        }
+
+        std::vector<std::vector<std::string>> perTarget(targetKeys.size());
+        std::exception_ptr error;
+        if (!targetKeys.empty()) {
+            try {
+                perTarget.back() = translateMultiple(std::move(intermediate), targetKeys.back().c_str());
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        // 先等所有任务结束（它们引用了 intermediate），再抛出第一个错误
+        for (size_t t = 0; t < futures.size(); ++t) {
+            try {
+                perTarget[t] = futures[t].get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
         std::vector<std::string> results;
-        results.reserve(responses.size());
-        for (const auto &response: responses) {
-            results.push_back(response.target.text);
+        results.reserve(targetKeys.size() * inputCount);
+        for (auto &translations: perTarget) {
+            if (translations.size() != inputCount) {
+                throw std::runtime_error("Translation count does not match input");
+            }
+            for (auto &translation: translations) {
+                results.push_back(std::move(translation));
+            }
         }
-        
         return results;
     }
     
+    // 增量翻译会话，句柄在整个进程内有效，可跨 isolate 使用
+    std::mutex session_mutex;
+    std::unordered_map<int64_t, std::shared_ptr<bergamot_plugin::TranslationSession>> sessions;
+    int64_t next_session = 1;
+
+    int64_t createSession(const char *key, const char *pivotKey) {
+        initializeService();
+
+        std::string firstKey(key);
+        if (!modelAvailable(firstKey)) {
+            throw std::runtime_error("Model not loaded: " + firstKey);
+        }
+        bergamot_plugin::TranslateBatch translate;
+        if (pivotKey == nullptr) {
+            translate = [firstKey](std::vector<std::string> &&inputs) {
+                return translateMultiple(std::move(inputs), firstKey.c_str());
+            };
+        } else {
+            std::string secondKey(pivotKey);
+            if (!modelAvailable(secondKey)) {
+                throw std::runtime_error("Second model not loaded: " + secondKey);
+            }
+            translate = [firstKey, secondKey](std::vector<std::string> &&inputs) {
+                return pivotMultiple(firstKey.c_str(), secondKey.c_str(), std::move(inputs));
+            };
+        }
+
+        auto session = std::make_shared<bergamot_plugin::TranslationSession>(std::move(translate));
+        std::lock_guard<std::mutex> lock(session_mutex);
+        int64_t handle = next_session++;
+        sessions[handle] = std::move(session);
+        return handle;
+    }
+
+    std::shared_ptr<bergamot_plugin::TranslationSession> findSession(int64_t handle) {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        auto it = sessions.find(handle);
+        return it == sessions.end() ? nullptr : it->second;
+    }
+
+    // 把字符串数组打包进一次分配：指针表之后紧跟各个以 '\0' 结尾的字符串。
+    // 整块由 bergamot_free_string_array 一次释放。
+    char** packStringArray(const std::vector<std::string>& strings) {
+        bergamot_plugin::TraceSpan span("output_copy", (int64_t)strings.size());
+        size_t bytes = strings.size() * sizeof(char*);
+        for (const auto& str : strings) {
+            bytes += str.size() + 1;
+        }
+
+        char** array = (char**)malloc(bytes);
+        if (array == nullptr) {
+            return nullptr;
+        }
+
+        char* cursor = (char*)(array + strings.size());
+        for (size_t i = 0; i < strings.size(); ++i) {
+            memcpy(cursor, strings[i].data(), strings[i].size());
+            cursor[strings[i].size()] = '\0';
+            array[i] = cursor;
+            cursor += strings[i].size() + 1;
+        }
+        return array;
+    }
+
+    // 结构化结果的中间形式，之后由 packTranslationResult 打包为一块内存
+    struct DetailedResult {
+        bool sentenceMappings = false;
+        bool qualityScores = false;
+        bool alignment = false;
+
+        std::vector<std::string> targets;
+        std::vector<int> inputSentences{0};
+        std::vector<int> sourceSentenceSpans;
+        std::vector<int> targetSentenceSpans;
+        std::vector<float> sentenceScores;
+        std::vector<int> sentenceWordScores{0};
+        std::vector<float> wordScores;
+        std::vector<int> wordScoreSpans;
+        std::vector<int> sentenceSourceWords{0};
+        std::vector<int> sourceWordSpans;
+        std::vector<int> sentenceTargetWords{0};
+        std::vector<int> targetWordSpans;
+        std::vector<int> sentenceAlignments{0};
+        std::vector<int> alignmentPoints;
+        std::vector<float> alignmentProbs;
+    };
+
+    void appendSpan(std::vector<int>& spans, const ByteRange& range) {
+        spans.push_back((int)range.begin);
+        spans.push_back((int)range.end);
+    }
+
+    void appendResponse(DetailedResult& result, Response &&response, float alignmentThreshold) {
+        size_t sentences = response.target.numSentences();
+        for (size_t s = 0; s < sentences; ++s) {
+            if (result.sentenceMappings) {
+                appendSpan(result.sourceSentenceSpans, response.source.sentenceAsByteRange(s));
+                appendSpan(result.targetSentenceSpans, response.target.sentenceAsByteRange(s));
+            }
+
+            if (result.qualityScores && s < response.qualityScores.size()) {
+                const auto& quality = response.qualityScores[s];
+                result.sentenceScores.push_back(quality.sentenceScore);
+                result.wordScores.insert(result.wordScores.end(), quality.wordScores.begin(), quality.wordScores.end());
+                for (const auto& range : quality.wordByteRanges) {
+                    appendSpan(result.wordScoreSpans, range);
+                }
+            } else if (result.qualityScores) {
+                result.sentenceScores.push_back(0.0f);
+            }
+            if (result.qualityScores) {
+                result.sentenceWordScores.push_back((int)result.wordScores.size());
+            }
+
+            if (result.alignment) {
+                size_t sourceWords = response.source.numWords(s);
+                size_t targetWords = response.target.numWords(s);
+                for (size_t w = 0; w < sourceWords; ++w) {
+                    appendSpan(result.sourceWordSpans, response.source.wordAsByteRange(s, w));
+                }
+                for (size_t w = 0; w < targetWords; ++w) {
+                    appendSpan(result.targetWordSpans, response.target.wordAsByteRange(s, w));
+                }
+                result.sentenceSourceWords.push_back((int)(result.sourceWordSpans.size() / 2));
+                result.sentenceTargetWords.push_back((int)(result.targetWordSpans.size() / 2));
+
+                if (s < response.alignments.size()) {
+                    // alignments[s][t][w]: 目标词 t 与源词 w 对齐的概率
+                    const auto& alignment = response.alignments[s];
+                    for (size_t t = 0; t < alignment.size() && t < targetWords; ++t) {
+                        for (size_t w = 0; w < alignment[t].size() && w < sourceWords; ++w) {
+                            if (alignment[t][w] >= alignmentThreshold) {
+                                result.alignmentPoints.push_back((int)t);
+                                result.alignmentPoints.push_back((int)w);
+                                result.alignmentProbs.push_back(alignment[t][w]);
+                            }
+                        }
+                    }
+                }
+                result.sentenceAlignments.push_back((int)result.alignmentProbs.size());
+            }
+        }
+
+        result.inputSentences.push_back(result.inputSentences.back() + (int)sentences);
+        result.targets.push_back(std::move(response.target.text));
+    }
+
+    // 与 packStringArray 相同：结构体、各数组与字符串依次放在一块内存中，一次释放
+    class TranslationResultPacker {
+    public:
+        explicit TranslationResultPacker(char* base) : cursor_(base) {}
+
+        template <typename T>
+        T* place(const std::vector<T>& values, bool present) {
+            if (!present) {
+                return nullptr;
+            }
+            T* out = (T*)cursor_;
+            if (!values.empty()) {
+                memcpy(out, values.data(), values.size() * sizeof(T));
+            }
+            cursor_ += alignedSize(values.size() * sizeof(T));
+            return out;
+        }
+
+        char* placeString(const std::string& str) {
+            char* out = cursor_;
+            memcpy(out, str.data(), str.size());
+            out[str.size()] = '\0';
+            cursor_ += str.size() + 1;
+            return out;
+        }
+
+        char** reserveStrings(size_t count) {
+            char** out = (char**)cursor_;
+            cursor_ += alignedSize(count * sizeof(char*));
+            return out;
+        }
+
+        static size_t alignedSize(size_t bytes) {
+            return (bytes + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        }
+
+        template <typename T>
+        static size_t arraySize(const std::vector<T>& values, bool present) {
+            return present ? alignedSize(values.size() * sizeof(T)) : 0;
+        }
+
+    private:
+        char* cursor_;
+    };
+
+    BergamotTranslationResult* packTranslationResult(const DetailedResult& r) {
+        bergamot_plugin::TraceSpan span("output_copy", (int64_t)r.targets.size());
+        using Packer = TranslationResultPacker;
+        size_t bytes = Packer::alignedSize(sizeof(BergamotTranslationResult))
+            + Packer::alignedSize(r.targets.size() * sizeof(char*))
+            + Packer::arraySize(r.inputSentences, true)
+            + Packer::arraySize(r.sourceSentenceSpans, r.sentenceMappings)
+            + Packer::arraySize(r.targetSentenceSpans, r.sentenceMappings)
+            + Packer::arraySize(r.sentenceScores, r.qualityScores)
+            + Packer::arraySize(r.sentenceWordScores, r.qualityScores)
+            + Packer::arraySize(r.wordScores, r.qualityScores)
+            + Packer::arraySize(r.wordScoreSpans, r.qualityScores)
+            + Packer::arraySize(r.sentenceSourceWords, r.alignment)
+            + Packer::arraySize(r.sourceWordSpans, r.alignment)
+            + Packer::arraySize(r.sentenceTargetWords, r.alignment)
+            + Packer::arraySize(r.targetWordSpans, r.alignment)
+            + Packer::arraySize(r.sentenceAlignments, r.alignment)
+            + Packer::arraySize(r.alignmentPoints, r.alignment)
+            + Packer::arraySize(r.alignmentProbs, r.alignment);
+        for (const auto& target : r.targets) {
+            bytes += target.size() + 1;
+        }
+
+        char* block = (char*)malloc(bytes);
+        if (block == nullptr) {
+            return nullptr;
+        }
+
+        auto* out = (BergamotTranslationResult*)block;
+        Packer packer(block + Packer::alignedSize(sizeof(BergamotTranslationResult)));
+
+        out->input_count = (int)r.targets.size();
+        out->targets = packer.reserveStrings(r.targets.size());
+        out->sentence_count = r.inputSentences.back();
+        out->input_sentences = packer.place(r.inputSentences, true);
+
+        out->source_sentence_spans = packer.place(r.sourceSentenceSpans, r.sentenceMappings);
+        out->target_sentence_spans = packer.place(r.targetSentenceSpans, r.sentenceMappings);
+
+        out->sentence_scores = packer.place(r.sentenceScores, r.qualityScores);
+        out->word_score_count = r.qualityScores ? (int)r.wordScores.size() : 0;
+        out->sentence_word_scores = packer.place(r.sentenceWordScores, r.qualityScores);
+        out->word_scores = packer.place(r.wordScores, r.qualityScores);
+        out->word_score_spans = packer.place(r.wordScoreSpans, r.qualityScores);
+
+        out->source_word_count = r.alignment ? (int)(r.sourceWordSpans.size() / 2) : 0;
+        out->sentence_source_words = packer.place(r.sentenceSourceWords, r.alignment);
+        out->source_word_spans = packer.place(r.sourceWordSpans, r.alignment);
+        out->target_word_count = r.alignment ? (int)(r.targetWordSpans.size() / 2) : 0;
+        out->sentence_target_words = packer.place(r.sentenceTargetWords, r.alignment);
+        out->target_word_spans = packer.place(r.targetWordSpans, r.alignment);
+        out->alignment_count = r.alignment ? (int)r.alignmentProbs.size() : 0;
+        out->sentence_alignments = packer.place(r.sentenceAlignments, r.alignment);
+        out->alignment_points = packer.place(r.alignmentPoints, r.alignment);
+        out->alignment_probs = packer.place(r.alignmentProbs, r.alignment);
+
+        // 字符串放在最后，之后不再需要对齐
+        for (size_t i = 0; i < r.targets.size(); ++i) {
+            out->targets[i] = packer.placeString(r.targets[i]);
+        }
+        return out;
+    }
+
+    BergamotTranslationResult* translateDetailed(std::vector<std::string> &&inputs, const char *key,
+                                                 int options, float alignmentThreshold) {
+        initializeService();
+
+        std::string key_str(key);
+
+        // 检查模型是否已加载
+        std::shared_ptr<ModelEntry> model = findModel(key_str);
+        if (model == nullptr) {
+            throw std::runtime_error("Model not loaded: " + key_str);
+        }
+
+        DetailedResult result;
+        result.qualityScores = (options & BERGAMOT_RESULT_QUALITY_SCORES) != 0;
+        if (result.qualityScores && !model->hasCosts) {
+            throw std::runtime_error("Quality scores need decoder costs; set 'skip-cost: false' in the config of model " + key_str);
+        }
+        result.alignment = (options & BERGAMOT_RESULT_ALIGNMENT) != 0;
+        result.sentenceMappings = (options & BERGAMOT_RESULT_SENTENCE_MAPPINGS) != 0;
+
+        ResponseOptions opts;
+        opts.HTML = (options & BERGAMOT_RESULT_HTML) != 0;
+        opts.qualityScores = result.qualityScores;
+        // HTML 模式依靠对齐把标签放回译文
+        opts.alignment = result.alignment || opts.HTML;
+        opts.sentenceMappings = result.sentenceMappings || result.alignment;
+        std::vector<ResponseOptions> responseOptions(inputs.size(), opts);
+
+        size_t count = inputs.size();
+        std::vector<Response> responses = translateWith<Response>(*model, std::move(inputs), responseOptions,
+                                                                  [](Response &&response) { return std::move(response); });
+        result.targets.reserve(count);
+        for (auto &response: responses) {
+            appendResponse(result, std::move(response), alignmentThreshold);
+        }
+
+        BergamotTranslationResult* packed = packTranslationResult(result);
+        if (packed == nullptr) {
+            throw std::bad_alloc();
+        }
+        return packed;
+    }
+
     struct DetectionResult {
         std::string language;
         bool isReliable;
@@ -200,10 +1553,73 @@ namespace {
         };
     }
     
+    // 回收空闲内存：
+    // - 翻译过且没有进行中请求的模型换成新构造的实例：旧实例的计算图、工作区及权重副本随之释放，
+    //   新实例在下一次翻译时再按需创建（模型内容标识不变，结果缓存仍然有效）
+    // - 结果缓存只保留最近使用的 trim_cache_entries 条
+    // - 关闭空闲的守护进程连接，并让分配器把空闲页还给操作系统
+    void trimMemory() {
+        // 与模型替换互斥。新实例在 service_mutex 之外构造，期间翻译与加载照常进行；
+        // 逐个模型重建并立即释放旧实例，同一时刻最多多占一个模型的内存
+        std::lock_guard<std::mutex> replace_lock(model_replace_mutex);
+
+        std::vector<std::pair<std::string, std::shared_ptr<ModelEntry>>> candidates;
+        std::vector<size_t> workers;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(service_mutex);
+            for (const auto& item : MODEL_CACHE) {
+                const std::shared_ptr<ModelEntry>& entry = item.second;
+                // findModel 同样在 service_mutex 下取得引用：只有缓存持有时没有进行中的请求
+                if (entry->used.load() && entry.use_count() == 1 && entry->reloadMemory) {
+                    candidates.emplace_back(item.first, entry);
+                }
+            }
+            workers = replicaWorkers();
+            generation = service_generation;
+        }
+
+        for (auto& candidate : candidates) {
+            std::shared_ptr<ModelEntry> old = std::move(candidate.second);
+            std::shared_ptr<ModelEntry> fresh;
+            try {
+                uint64_t identity = 0;
+                fresh = createModelEntry(old->options, [&] { return old->reloadMemory(identity); }, workers);
+                // 文件内容未变时沿用原标识，结果缓存仍然有效；变了则是新标识
+                fresh->identity = identity;
+                fresh->options = old->options;
+                fresh->reloadMemory = old->reloadMemory;
+            } catch (const std::exception &e) {
+                std::cerr << "[trimMemory] Failed to rebuild model " << candidate.first << ": " << e.what() << std::endl;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(service_mutex);
+            if (generation != service_generation) {
+                break;  // 服务已重新配置，新实例的工作线程数不再匹配
+            }
+            auto it = MODEL_CACHE.find(candidate.first);
+            if (it != MODEL_CACHE.end() && it->second == old) {
+                it->second = std::move(fresh);
+            }
+            // 期间被替换或卸载的模型保持原样；fresh 与 old 在下一轮前（锁外）释放
+        }
+        candidates.clear();
+        pruneVocabRegistry();
+
+        bergamot_plugin::trimResultCache(trim_cache_entries.load());
+        bergamot_plugin::trimDaemonConnections();
+        bergamot_plugin::releaseFreeHeap();
+    }
+
     void cleanup() {
         std::lock_guard<std::mutex> lock(service_mutex);
-        // Do not delete global_service (see note above); just drop references.
-        global_service = nullptr;
+        destroyServices();
+        bergamot_plugin::clearResultCache();
+        {
+            std::lock_guard<std::mutex> session_lock(session_mutex);
+            sessions.clear();
+        }
 
         // Do NOT clear the model cache on macOS: destroying marian objects can
         // throw during shutdown and abort the process.
@@ -213,17 +1629,234 @@ namespace {
     }
 }
 
-// C FFI 接口实现
-extern "C" {
+// C FFI 接口实现
+extern "C" {
+
+FFI_PLUGIN_EXPORT int bergamot_initialize_service(void) {
+    try {
+        initializeService();
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_initialize_service] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_configure_service(const BergamotServiceConfig* config) {
+    if (config == nullptr || config->num_workers < 0 || config->cache_size < 0) {
+        std::cerr << "[bergamot_configure_service] Error: config parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        ServiceSettings settings;
+        settings.numWorkers = (size_t)config->num_workers;
+        settings.cacheSize = (size_t)config->cache_size;
+        if (config->cpu_set != nullptr) {
+            settings.cpus = bergamot_plugin::parseCpuList(config->cpu_set);
+        }
+        settings.numaReplicas = config->numa_replicas != 0;
+        if (config->preprocess_threads > 0) {
+            if (config->num_workers == 0) {
+                // BlockingService 在一次调用内完成预处理与解码，无法拆开
+                throw std::invalid_argument("preprocess_threads requires num_workers > 0");
+            }
+            settings.preprocessThreads = (size_t)config->preprocess_threads;
+        }
+        configureService(settings);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_configure_service] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_result_cache(int capacity) {
+    if (capacity < 0) {
+        std::cerr << "[bergamot_set_result_cache] Error: capacity is invalid" << std::endl;
+        return -1;
+    }
+
+    bergamot_plugin::setResultCacheCapacity((size_t)capacity);
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT int bergamot_get_result_cache_stats(BergamotCacheStats* stats) {
+    if (stats == nullptr) {
+        std::cerr << "[bergamot_get_result_cache_stats] Error: stats is null" << std::endl;
+        return -1;
+    }
+
+    bergamot_plugin::ResultCacheStats current = bergamot_plugin::resultCacheStats();
+    stats->hits = (int64_t)current.hits;
+    stats->misses = (int64_t)current.misses;
+    stats->entries = (int64_t)current.entries;
+    stats->capacity = (int64_t)current.capacity;
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT int bergamot_get_coalescing_stats(BergamotCoalescingStats* stats) {
+    if (stats == nullptr) {
+        std::cerr << "[bergamot_get_coalescing_stats] Error: stats is null" << std::endl;
+        return -1;
+    }
+
+    bergamot_plugin::InflightStats current = bergamot_plugin::inflightStats();
+    stats->decoded = (int64_t)current.decoded;
+    stats->coalesced = (int64_t)current.coalesced;
+    stats->pending = (int64_t)current.pending;
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT int bergamot_get_memory_stats(BergamotMemoryStats** stats) {
+    if (stats == nullptr) {
+        std::cerr << "[bergamot_get_memory_stats] Error: stats is null" << std::endl;
+        return -1;
+    }
+
+    try {
+        size_t vocabBytes = 0;
+        std::vector<ModelMemoryUsage> usage = modelMemoryUsage(vocabBytes);
+
+        // 结构体、模型数组与各个键放在同一块内存中
+        size_t bytes = sizeof(BergamotMemoryStats) + usage.size() * sizeof(BergamotModelMemory);
+        for (const auto& model : usage) {
+            bytes += model.key.size() + 1;
+        }
+        char* block = (char*)calloc(1, bytes);
+        if (block == nullptr) {
+            return -1;
+        }
+        BergamotMemoryStats* out = (BergamotMemoryStats*)block;
+        out->models = (BergamotModelMemory*)(block + sizeof(BergamotMemoryStats));
+        char* keys = (char*)(out->models + usage.size());
+
+        int64_t tracked = (int64_t)vocabBytes;
+        for (size_t i = 0; i < usage.size(); ++i) {
+            const ModelEntry& entry = *usage[i].entry;
+            BergamotModelMemory& model = out->models[i];
+            model.key = keys;
+            memcpy(keys, usage[i].key.c_str(), usage[i].key.size() + 1);
+            keys += usage[i].key.size() + 1;
+            model.model_bytes = (int64_t)entry.modelBytes;
+            model.vocab_bytes = (int64_t)entry.vocabBytes;
+            model.shortlist_bytes = (int64_t)entry.shortlistBytes;
+            model.other_bytes = (int64_t)entry.otherBytes;
+            model.workspace_bytes = (int64_t)entry.workspaceBytes;
+            model.workers = (int)entry.workers;
+            tracked += model.model_bytes + model.shortlist_bytes + model.other_bytes + model.workspace_bytes;
+        }
+        out->model_count = (int)usage.size();
+        out->vocab_bytes = (int64_t)vocabBytes;
+
+        bergamot_plugin::ResultCacheStats cache = bergamot_plugin::resultCacheStats();
+        out->result_cache_bytes = (int64_t)cache.bytes;
+        out->result_cache_entries = (int64_t)cache.entries;
+        out->tracked_bytes = tracked + out->result_cache_bytes;
+
+        bergamot_plugin::ProcessMemory process = bergamot_plugin::processMemory();
+        out->process_resident_bytes = process.resident;
+        out->process_peak_resident_bytes = process.peakResident;
+
+        *stats = out;
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_get_memory_stats] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT void bergamot_free_memory_stats(BergamotMemoryStats* stats) {
+    free(stats);
+}
+
+FFI_PLUGIN_EXPORT int bergamot_trim_memory(void) {
+    try {
+        trimMemory();
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_trim_memory] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_idle_trim(int idle_seconds, int keep_cache_entries) {
+    if (idle_seconds < 0 || keep_cache_entries < 0) {
+        std::cerr << "[bergamot_set_idle_trim] Error: parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        trim_cache_entries.store((size_t)keep_cache_entries);
+        bergamot_plugin::setIdleTrim((unsigned)idle_seconds, [] {
+            try {
+                trimMemory();
+            } catch (const std::exception &e) {
+                std::cerr << "[bergamot_set_idle_trim] Error: " << e.what() << std::endl;
+            }
+        });
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_set_idle_trim] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_tracing(int enabled, int capacity) {
+    if (capacity < 0) {
+        std::cerr << "[bergamot_set_tracing] Error: capacity is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::setTracing(enabled != 0, capacity > 0 ? (size_t)capacity : kDefaultTraceCapacity);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_set_tracing] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_dump_trace(char** json) {
+    if (json == nullptr) {
+        std::cerr << "[bergamot_dump_trace] Error: json is null" << std::endl;
+        return -1;
+    }
 
-FFI_PLUGIN_EXPORT int bergamot_initialize_service(void) {
     try {
-        initializeService();
+        std::string trace = bergamot_plugin::traceJson();
+        char* buffer = (char*)malloc(trace.size() + 1);
+        if (buffer == nullptr) {
+            return -1;
+        }
+        memcpy(buffer, trace.data(), trace.size());
+        buffer[trace.size()] = '\0';
+        *json = buffer;
         return 0;
     } catch (const std::exception &e) {
-        std::cerr << "[bergamot_initialize_service] Error: " << e.what() << std::endl;
+        std::cerr << "[bergamot_dump_trace] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_repetition_limit(int max_repeats) {
+    if (max_repeats < 0) {
+        std::cerr << "[bergamot_set_repetition_limit] Error: max_repeats is invalid" << std::endl;
+        return -1;
+    }
+
+    repetition_limit.store((size_t)max_repeats);
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_passthrough(int flags) {
+    if (flags < 0 || (flags & ~(BERGAMOT_PASSTHROUGH_SEGMENTS | BERGAMOT_PASSTHROUGH_SPANS)) != 0) {
+        std::cerr << "[bergamot_set_passthrough] Error: flags is invalid" << std::endl;
         return -1;
     }
+
+    passthrough_flags.store(flags);
+    return 0;
 }
 
 FFI_PLUGIN_EXPORT int bergamot_load_model(const char* cfg, const char* key) {
@@ -236,6 +1869,12 @@ FFI_PLUGIN_EXPORT int bergamot_load_model(const char* cfg, const char* key) {
         std::string cfg_str(cfg);
         std::string key_str(key);
         
+        // 客户端模式：由守护进程加载（配置中的路径按守护进程解析）
+        if (bergamot_plugin::daemonConnected()) {
+            bergamot_plugin::daemonCall(bergamot_plugin::kDaemonLoadModel, {cfg_str, key_str});
+            return 0;
+        }
+        
         // 确保服务已初始化
         initializeService();
         
@@ -251,6 +1890,92 @@ FFI_PLUGIN_EXPORT int bergamot_load_model(const char* cfg, const char* key) {
     }
 }
 
+FFI_PLUGIN_EXPORT int bergamot_load_model_bundle(const char* path, const char* key) {
+    if (path == nullptr || key == nullptr) {
+        std::cerr << "[bergamot_load_model_bundle] Error: path or key parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        if (bergamot_plugin::daemonConnected()) {
+            bergamot_plugin::daemonCall(bergamot_plugin::kDaemonLoadBundle, {path, key});
+            return 0;
+        }
+        initializeService();
+        loadModelBundleIntoCache(path, key);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_load_model_bundle] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_load_model_bundle] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_replace_model(const char* cfg, const char* key) {
+    if (cfg == nullptr || key == nullptr) {
+        std::cerr << "[bergamot_replace_model] Error: cfg or key parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        std::string cfg_str(cfg);
+        std::string key_str(key);
+        if (bergamot_plugin::daemonConnected()) {
+            bergamot_plugin::daemonCall(bergamot_plugin::kDaemonReplaceModel, {cfg_str, key_str});
+            return 0;
+        }
+        initializeService();
+        replaceModelInCache(key_str, false, [&](const std::vector<size_t>& workers) {
+            return buildModelFromConfig(cfg_str, workers);
+        });
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_replace_model] Error: Failed to replace model " << key << ": " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_replace_model] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_replace_model_bundle(const char* path, const char* key) {
+    if (path == nullptr || key == nullptr) {
+        std::cerr << "[bergamot_replace_model_bundle] Error: path or key parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        std::string path_str(path);
+        if (bergamot_plugin::daemonConnected()) {
+            bergamot_plugin::daemonCall(bergamot_plugin::kDaemonReplaceBundle, {path_str, key});
+            return 0;
+        }
+        initializeService();
+        replaceModelInCache(key, true, [&](const std::vector<size_t>& workers) {
+            return buildModelFromBundle(path_str, workers);
+        });
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_replace_model_bundle] Error: Failed to replace model " << key << ": " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_replace_model_bundle] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_set_weight_cache(int enabled, const char* cache_dir) {
+    try {
+        bergamot_plugin::setWeightCache(enabled != 0, cache_dir != nullptr ? cache_dir : "");
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_set_weight_cache] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
 FFI_PLUGIN_EXPORT int bergamot_translate_multiple(
     const char** inputs,
     int input_count,
@@ -264,6 +1989,7 @@ FFI_PLUGIN_EXPORT int bergamot_translate_multiple(
     }
     
     try {
+        bergamot_plugin::TraceRequest trace("bergamot_translate_multiple", input_count);
         std::vector<std::string> cpp_inputs;
         cpp_inputs.reserve(input_count);
         
@@ -277,27 +2003,11 @@ FFI_PLUGIN_EXPORT int bergamot_translate_multiple(
         
         std::vector<std::string> translations = translateMultiple(std::move(cpp_inputs), key);
         
-        // 分配输出数组
-        char** result_array = (char**)malloc(translations.size() * sizeof(char*));
+        char** result_array = packStringArray(translations);
         if (result_array == nullptr) {
             return -1;
         }
         
-        for (size_t i = 0; i < translations.size(); ++i) {
-            size_t len = translations[i].length();
-            result_array[i] = (char*)malloc((len + 1) * sizeof(char));
-            if (result_array[i] == nullptr) {
-                // 清理已分配的内存
-                for (size_t j = 0; j < i; ++j) {
-                    free(result_array[j]);
-                }
-                free(result_array);
-                return -1;
-            }
-            strncpy(result_array[i], translations[i].c_str(), len);
-            result_array[i][len] = '\0';
-        }
-        
         *outputs = result_array;
         *output_count = (int)translations.size();
         return 0;
@@ -325,6 +2035,7 @@ FFI_PLUGIN_EXPORT int bergamot_pivot_multiple(
     }
     
     try {
+        bergamot_plugin::TraceRequest trace("bergamot_pivot_multiple", input_count);
         std::vector<std::string> cpp_inputs;
         cpp_inputs.reserve(input_count);
         
@@ -338,36 +2049,238 @@ FFI_PLUGIN_EXPORT int bergamot_pivot_multiple(
         
         std::vector<std::string> translations = pivotMultiple(first_key, second_key, std::move(cpp_inputs));
         
-        // 分配输出数组
-        char** result_array = (char**)malloc(translations.size() * sizeof(char*));
+        char** result_array = packStringArray(translations);
         if (result_array == nullptr) {
             return -1;
         }
         
-        for (size_t i = 0; i < translations.size(); ++i) {
-            size_t len = translations[i].length();
-            result_array[i] = (char*)malloc((len + 1) * sizeof(char));
-            if (result_array[i] == nullptr) {
-                // 清理已分配的内存
-                for (size_t j = 0; j < i; ++j) {
-                    free(result_array[j]);
-                }
-                free(result_array);
+        *outputs = result_array;
+        *output_count = (int)translations.size();
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_pivot_multiple] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_pivot_fan_out(
+    const char* source_key,
+    const char** target_keys,
+    int target_count,
+    const char** inputs,
+    int input_count,
+    char*** outputs,
+    int* output_count
+) {
+    if (source_key == nullptr || target_keys == nullptr || target_count <= 0 || inputs == nullptr ||
+        input_count <= 0 || outputs == nullptr || output_count == nullptr) {
+        std::cerr << "[bergamot_pivot_fan_out] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::TraceRequest trace("bergamot_pivot_fan_out", input_count);
+        std::vector<std::string> keys;
+        keys.reserve(target_count);
+        for (int i = 0; i < target_count; i++) {
+            if (target_keys[i] == nullptr) {
+                std::cerr << "[bergamot_pivot_fan_out] Error: target key is null" << std::endl;
                 return -1;
             }
-            strncpy(result_array[i], translations[i].c_str(), len);
-            result_array[i][len] = '\0';
+            keys.emplace_back(target_keys[i]);
         }
-        
+
+        std::vector<std::string> cpp_inputs;
+        cpp_inputs.reserve(input_count);
+        for (int i = 0; i < input_count; i++) {
+            if (inputs[i] != nullptr) {
+                cpp_inputs.emplace_back(inputs[i]);
+            } else {
+                cpp_inputs.emplace_back("");
+            }
+        }
+
+        std::vector<std::string> translations = pivotFanOut(source_key, keys, std::move(cpp_inputs));
+
+        char** result_array = packStringArray(translations);
+        if (result_array == nullptr) {
+            return -1;
+        }
+
         *outputs = result_array;
         *output_count = (int)translations.size();
         return 0;
     } catch (const std::exception &e) {
-        std::cerr << "[bergamot_pivot_multiple] Error: " << e.what() << std::endl;
+        std::cerr << "[bergamot_pivot_fan_out] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_pivot_fan_out] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_translate_packed(
+    const char* key,
+    const char* pivot_key,
+    const char* inputs,
+    int64_t input_bytes,
+    char** outputs,
+    int64_t* output_bytes
+) {
+    if (key == nullptr || (inputs == nullptr && input_bytes > 0) || input_bytes < 0 ||
+        outputs == nullptr || output_bytes == nullptr) {
+        std::cerr << "[bergamot_translate_packed] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        // 每条输入以 '\0' 结尾，依次相连
+        std::vector<std::string> cpp_inputs;
+        int64_t begin = 0;
+        for (int64_t i = 0; i < input_bytes; ++i) {
+            if (inputs[i] == '\0') {
+                cpp_inputs.emplace_back(inputs + begin, (size_t)(i - begin));
+                begin = i + 1;
+            }
+        }
+        if (begin != input_bytes) {
+            std::cerr << "[bergamot_translate_packed] Error: last input is not terminated" << std::endl;
+            return -1;
+        }
+
+        bergamot_plugin::TraceRequest trace("bergamot_translate_packed", (int64_t)cpp_inputs.size());
+        std::vector<std::string> translations;
+        if (!cpp_inputs.empty()) {
+            translations = pivot_key != nullptr ? pivotMultiple(key, pivot_key, std::move(cpp_inputs))
+                                                : translateMultiple(std::move(cpp_inputs), key);
+        }
+
+        bergamot_plugin::TraceSpan copy("output_copy", (int64_t)translations.size());
+        size_t bytes = 0;
+        for (auto& translation : translations) {
+            // 译文中的 '\0' 会被读成分隔符，使之后的译文错位；它没有可见内容，直接去掉
+            translation.erase(std::remove(translation.begin(), translation.end(), '\0'), translation.end());
+            bytes += translation.size() + 1;
+        }
+        char* buffer = (char*)malloc(bytes > 0 ? bytes : 1);
+        if (buffer == nullptr) {
+            return -1;
+        }
+        char* cursor = buffer;
+        for (const auto& translation : translations) {
+            memcpy(cursor, translation.data(), translation.size());
+            cursor[translation.size()] = '\0';
+            cursor += translation.size() + 1;
+        }
+
+        *outputs = buffer;
+        *output_bytes = (int64_t)bytes;
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_translate_packed] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_translate_packed] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_translate_detailed(
+    const char** inputs,
+    int input_count,
+    const char* key,
+    int options,
+    float alignment_threshold,
+    BergamotTranslationResult** result
+) {
+    if (inputs == nullptr || input_count <= 0 || key == nullptr || result == nullptr) {
+        std::cerr << "[bergamot_translate_detailed] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::TraceRequest trace("bergamot_translate_detailed", input_count);
+        std::vector<std::string> cpp_inputs;
+        cpp_inputs.reserve(input_count);
+
+        for (int i = 0; i < input_count; i++) {
+            if (inputs[i] != nullptr) {
+                cpp_inputs.emplace_back(inputs[i]);
+            } else {
+                cpp_inputs.emplace_back("");
+            }
+        }
+
+        *result = translateDetailed(std::move(cpp_inputs), key, options, alignment_threshold);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_translate_detailed] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_translate_detailed] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_translate_file(
+    const char* in_path,
+    const char* out_path,
+    const char* key,
+    const BergamotFileOptions* options
+) {
+    if (in_path == nullptr || out_path == nullptr || key == nullptr) {
+        std::cerr << "[bergamot_translate_file] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::TraceRequest trace("bergamot_translate_file", -1);
+        FileJob job(key, options);
+        bergamot_plugin::translateTextFile(in_path, out_path, job.pipelineOptions, job.translate(), job.progress);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_translate_file] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_translate_file] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_translate_jsonl(
+    const char* in_path,
+    const char* out_path,
+    const char* key,
+    const char* field,
+    const char* output_field,
+    const BergamotFileOptions* options
+) {
+    if (in_path == nullptr || out_path == nullptr || key == nullptr || field == nullptr || field[0] == '\0') {
+        std::cerr << "[bergamot_translate_jsonl] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::TraceRequest trace("bergamot_translate_jsonl", -1);
+        FileJob job(key, options);
+        bergamot_plugin::translateJsonlFile(in_path, out_path, job.pipelineOptions, field,
+                                            output_field != nullptr ? output_field : "",
+                                            job.translate(), job.progress);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_translate_jsonl] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_translate_jsonl] Error: Unknown error" << std::endl;
         return -1;
     }
 }
 
+FFI_PLUGIN_EXPORT void bergamot_free_translation_result(BergamotTranslationResult* result) {
+    // 整个结果位于一块内存中（见 packTranslationResult）
+    free(result);
+}
+
 FFI_PLUGIN_EXPORT int bergamot_detect_language(
     const char* text,
     const char* hint,
@@ -395,6 +2308,102 @@ FFI_PLUGIN_EXPORT int bergamot_detect_language(
     }
 }
 
+FFI_PLUGIN_EXPORT int bergamot_get_cpu_info(BergamotCpuInfo* info) {
+    if (info == nullptr) {
+        std::cerr << "[bergamot_get_cpu_info] Error: info parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    const bergamot_plugin::CpuFeatures& features = bergamot_plugin::cpuFeatures();
+    strncpy(info->gemm_path, bergamot_plugin::gemmPathName(), sizeof(info->gemm_path) - 1);
+    info->gemm_path[sizeof(info->gemm_path) - 1] = '\0';
+    info->has_ssse3 = features.ssse3 ? 1 : 0;
+    info->has_sse41 = features.sse41 ? 1 : 0;
+    info->has_avx2 = features.avx2 ? 1 : 0;
+    info->has_avx512bw = features.avx512bw ? 1 : 0;
+    info->has_avx512vnni = features.avx512vnni ? 1 : 0;
+    info->has_neon = features.neon ? 1 : 0;
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT int bergamot_session_create(const char* key, const char* pivot_key, int64_t* session) {
+    if (key == nullptr || session == nullptr) {
+        std::cerr << "[bergamot_session_create] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        *session = createSession(key, pivot_key);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_session_create] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT int bergamot_session_update(int64_t session, const char* text, char** output, int* translated_sentences) {
+    if (text == nullptr || output == nullptr) {
+        std::cerr << "[bergamot_session_update] Error: inputs parameter is invalid" << std::endl;
+        return -1;
+    }
+
+    try {
+        std::shared_ptr<bergamot_plugin::TranslationSession> current = findSession(session);
+        if (current == nullptr) {
+            std::cerr << "[bergamot_session_update] Error: Session not found: " << session << std::endl;
+            return -1;
+        }
+
+        bergamot_plugin::TraceRequest trace("bergamot_session_update", -1);
+        size_t translated = 0;
+        std::string translation = current->update(text, translated);
+
+        bergamot_plugin::TraceSpan copy("output_copy", 1);
+        char* buffer = (char*)malloc(translation.size() + 1);
+        if (buffer == nullptr) {
+            return -1;
+        }
+        memcpy(buffer, translation.data(), translation.size());
+        buffer[translation.size()] = '\0';
+
+        *output = buffer;
+        if (translated_sentences != nullptr) {
+            *translated_sentences = (int)translated;
+        }
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_session_update] Error: " << e.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "[bergamot_session_update] Error: Unknown error" << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT void bergamot_session_destroy(int64_t session) {
+    std::lock_guard<std::mutex> lock(session_mutex);
+    sessions.erase(session);
+}
+
+FFI_PLUGIN_EXPORT int bergamot_connect_daemon(const char* socket_path) {
+    if (socket_path == nullptr) {
+        std::cerr << "[bergamot_connect_daemon] Error: socket_path is null" << std::endl;
+        return -1;
+    }
+
+    try {
+        bergamot_plugin::connectDaemon(socket_path);
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "[bergamot_connect_daemon] Error: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+FFI_PLUGIN_EXPORT void bergamot_disconnect_daemon(void) {
+    bergamot_plugin::disconnectDaemon();
+}
+
 FFI_PLUGIN_EXPORT void bergamot_cleanup(void) {
     cleanup();
 }
@@ -405,13 +2414,13 @@ FFI_PLUGIN_EXPORT void bergamot_free_string_array(char** array, int count) {
         return;
     }
     
-    for (int i = 0; i < count; i++) {
-        if (array[i] != nullptr) {
-            free(array[i]);
-        }
-    }
+    // 字符串与指针表在同一块内存中（见 packStringArray）
     free(array);
 }
 
+FFI_PLUGIN_EXPORT void bergamot_free_string(char* str) {
+    free(str);
+}
+
 } // extern "C"
 
@@ -28,16 +28,228 @@ typedef struct {
     int confidence;        // 置信度（0-100）
 } BergamotDetectionResult;
 
+// CPU 特性与矩阵乘法路径
+typedef struct {
+    char gemm_path[32];    // 实际使用的 int8 矩阵乘法路径（如 "intgemm-avx2", "ruy-neon"）
+    int has_ssse3;         // 以下为检测到的指令集（0/1）
+    int has_sse41;
+    int has_avx2;
+    int has_avx512bw;
+    int has_avx512vnni;
+    int has_neon;
+} BergamotCpuInfo;
+
+// 翻译服务配置
+typedef struct {
+    int num_workers;        // 工作线程总数；0 表示在调用线程上同步翻译（默认）
+    int cache_size;         // 翻译缓存条目数，0 表示禁用（默认 256）
+    const char* cpu_set;    // 工作线程允许运行的 CPU 列表（如 "0-7,16-23"），NULL 表示不限制（仅 Linux/Android 生效）
+    int numa_replicas;      // 1: 每个 NUMA 节点一个服务及模型副本，工作线程绑定到本节点，
+                            //    请求路由到调用线程所在节点的副本；num_workers 在各节点间平分
+    int preprocess_threads; // 断句与子词编码线程数（需 num_workers > 0），0 表示在调用线程上处理；
+                            //    预处理与解码重叠，多个请求的预处理彼此并行
+} BergamotServiceConfig;
+
+// bergamot_set_passthrough 的选项（按位组合）
+#define BERGAMOT_PASSTHROUGH_SEGMENTS 1   // 整段为数字、URL、邮箱、哈希时不翻译，原样返回
+#define BERGAMOT_PASSTHROUGH_SPANS    2   // 句中的 URL、邮箱、哈希替换为占位符后翻译，再换回原文
+
+// bergamot_translate_detailed 的请求选项（按位组合）
+// 未请求的部分不会计算，结果中对应数组为 NULL
+#define BERGAMOT_RESULT_QUALITY_SCORES    1   // 句子与词级质量分数
+#define BERGAMOT_RESULT_ALIGNMENT         2   // 源词-目标词对齐
+#define BERGAMOT_RESULT_SENTENCE_MAPPINGS 4   // 源句与译句的字节区间
+#define BERGAMOT_RESULT_HTML              8   // 输入为 HTML：只翻译文本内容，标签原样保留在译文中
+
+// 结构化翻译结果：所有数组按输入、句子顺序平铺
+// 字节区间为 [begin, end) 对，相对于对应输入的原文或译文；词下标在句内编号
+typedef struct {
+    int input_count;
+    char** targets;                     // [input_count] 译文
+    int sentence_count;                 // 全部输入的句子总数
+    int* input_sentences;               // [input_count + 1] 第 i 条输入的句子为 [input_sentences[i], input_sentences[i+1])
+
+    // BERGAMOT_RESULT_SENTENCE_MAPPINGS
+    int* source_sentence_spans;         // [sentence_count * 2]
+    int* target_sentence_spans;         // [sentence_count * 2]
+
+    // BERGAMOT_RESULT_QUALITY_SCORES
+    float* sentence_scores;             // [sentence_count]
+    int word_score_count;
+    int* sentence_word_scores;          // [sentence_count + 1] 每句的词级分数下标区间
+    float* word_scores;                 // [word_score_count]
+    int* word_score_spans;              // [word_score_count * 2] 被打分的词在译文中的字节区间
+
+    // BERGAMOT_RESULT_ALIGNMENT
+    int source_word_count;
+    int* sentence_source_words;         // [sentence_count + 1]
+    int* source_word_spans;             // [source_word_count * 2]
+    int target_word_count;
+    int* sentence_target_words;         // [sentence_count + 1]
+    int* target_word_spans;             // [target_word_count * 2]
+    int alignment_count;
+    int* sentence_alignments;           // [sentence_count + 1]
+    int* alignment_points;              // [alignment_count * 2] (目标词下标, 源词下标)
+    float* alignment_probs;             // [alignment_count]
+} BergamotTranslationResult;
+
+// 文件翻译进度回调：已写出的输入字节数、输入文件总字节数
+typedef void (*BergamotProgressCallback)(int64_t bytes_done, int64_t bytes_total, void* user_data);
+
+// 文件翻译选项
+typedef struct {
+    int chunk_bytes;                    // 每块输入字节数（按整行切分），0 使用默认值 64 KiB
+    int max_in_flight;                  // 同时翻译中的块数，0 使用默认值（工作线程数，至少 2）
+    int html;                           // 1: 每行按 HTML 翻译，标签原样保留
+    BergamotProgressCallback progress;  // 可为 NULL；在调用线程上、每写完一块调用一次
+    void* user_data;                    // 原样传给 progress
+} BergamotFileOptions;
+
+// 结果缓存统计
+typedef struct {
+    int64_t hits;
+    int64_t misses;
+    int64_t entries;
+    int64_t capacity;
+} BergamotCacheStats;
+
+// 相同请求合并统计
+typedef struct {
+    int64_t decoded;     // 实际交给解码器的输入数
+    int64_t coalesced;   // 合并到正在进行的相同解码、未重复解码的输入数
+    int64_t pending;     // 当前正在解码的不同输入数
+} BergamotCoalescingStats;
+
+// 单个模型交给翻译服务的内存（字节）；线程池模式下为所有服务副本之和
+typedef struct {
+    char* key;                  // 模型缓存键
+    int64_t model_bytes;        // 权重
+    int64_t vocab_bytes;        // 词表（与其他模型共享的词表在每个模型中都计入）
+    int64_t shortlist_bytes;    // 词表短名单
+    int64_t other_bytes;        // 断句前缀文件、质量估计模型
+    int64_t workspace_bytes;    // 解码工作区：每个工作线程按配置的 workspace 各预留一份
+    int workers;                // 持有该模型工作区的工作线程数
+} BergamotModelMemory;
+
+// 内存统计
+typedef struct {
+    int model_count;
+    BergamotModelMemory* models;        // [model_count]，按键排序
+    int64_t vocab_bytes;                // 去重后的词表总量
+    int64_t result_cache_bytes;         // 结果缓存（估算）
+    int64_t result_cache_entries;
+    int64_t tracked_bytes;              // 以上各项之和（词表按去重计）
+    int64_t process_resident_bytes;     // 进程常驻内存，-1 表示不可用
+    int64_t process_peak_resident_bytes;
+} BergamotMemoryStats;
+
 // 初始化翻译服务
 // 返回: 0 成功, 非0 失败
 FFI_PLUGIN_EXPORT int bergamot_initialize_service(void);
 
+// 配置翻译服务（线程数、CPU 绑定、NUMA 副本）
+// 必须在加载任何模型之前调用；已创建的服务会按新配置重建
+// config: 配置结构体指针
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_configure_service(const BergamotServiceConfig* config);
+
+// 设置输入文本级结果缓存的容量（条目数），0 关闭并清空（默认关闭）
+// 以 (模型内容, 输入文本) 为键，命中时跳过断句、子词编码与解码；
+// 所有服务副本共享，同一模型重新加载后仍然有效。HTML 与结构化结果不经过此缓存。
+// 只缓存完整译文：未命中的输入仍照常断句与子词编码（不缓存分词结果）
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_result_cache(int capacity);
+
+// 获取结果缓存统计（命中、未命中、条目数、容量）
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_get_result_cache_stats(BergamotCacheStats* stats);
+
+// 获取相同请求合并统计
+// 同一时刻对同一模型、同一输入文本的纯文本翻译请求只解码一次，其余请求共享结果
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_get_coalescing_stats(BergamotCoalescingStats* stats);
+
+// 获取内存统计：每个已加载模型按组件的占用、结果缓存占用，以及进程常驻内存
+// 模型各项为加载时交给 bergamot 的内存与按配置预留的工作区，不含 marian 的临时分配；
+// 客户端模式下模型在守护进程中，这里只反映本进程
+// stats: 输出结果（整个结果位于一块内存中）
+// 返回: 0 成功, 非0 失败
+// 注意: stats 需要调用 bergamot_free_memory_stats 释放
+FFI_PLUGIN_EXPORT int bergamot_get_memory_stats(BergamotMemoryStats** stats);
+
+// 释放内存统计
+FFI_PLUGIN_EXPORT void bergamot_free_memory_stats(BergamotMemoryStats* stats);
+
+// 立即回收空闲内存：翻译过且没有进行中请求的模型换成新实例，释放各工作线程的计算图与工作区
+// （下次翻译时按需重建）；结果缓存只保留 bergamot_set_idle_trim 设置的条目数（默认清空，容量不变）；
+// 关闭空闲的守护进程连接，并让分配器把空闲页还给操作系统
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_trim_memory(void);
+
+// 设置空闲回收：没有翻译请求持续 idle_seconds 秒后，在后台线程上执行一次 bergamot_trim_memory
+// idle_seconds: 0 关闭（默认）
+// keep_cache_entries: 回收时结果缓存保留的最近使用条目数，0 表示清空
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_idle_trim(int idle_seconds, int keep_cache_entries);
+
+// 开启或关闭请求生命周期追踪（默认关闭）
+// 开启后每个翻译请求分配一个编号，记录 FFI 调用、缓存查找、排队等待、断句、合并组批、解码、
+// 结果提取与输出拷贝等阶段；记录写入固定大小的环形缓冲区，满后覆盖最旧的记录
+// enabled: 非0 开启（清空已有记录），0 停止记录（已有记录保留，仍可导出）
+// capacity: 缓冲区可容纳的区间数，0 使用默认值 65536
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_tracing(int enabled, int capacity);
+
+// 导出追踪记录为 Chrome trace event JSON，可在 ui.perfetto.dev 或 chrome://tracing 中打开，
+// 每个请求一条轨道
+// json: 输出的 JSON 文本（调用者需要调用 bergamot_free_string 释放）
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_dump_trace(char** json);
+
+// 设置退化重复的折叠上限（默认 0，即关闭；建议值 8）
+// 折叠会改写输入与译文，只在能接受这种改写时开启。
+// 输入中连续重复超过该次数的 1~3 词片段在翻译前折叠，避免其解码到 max-length 上限而拖慢同批次的其他句子；
+// 译文中的重复循环同样折叠，并截断超过 4 倍长度的同一字母。数字、标点与符号不视为重复，原样保留。
+// 只作用于纯文本翻译，HTML 与结构化结果（字节区间需对应原文）不做处理
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_repetition_limit(int max_repeats);
+
+// 设置不需翻译内容的旁路（BERGAMOT_PASSTHROUGH_* 按位组合，0 关闭，默认关闭）
+// 使用 BERGAMOT_PASSTHROUGH_SPANS 时，若译文未完整保留占位符，该输入改为按原文重新翻译
+// 只作用于纯文本翻译，HTML 与结构化结果不做处理
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_passthrough(int flags);
+
 // 加载模型到缓存
 // cfg: 模型配置字符串（JSON格式）
 // key: 模型缓存键
 // 返回: 0 成功, 非0 失败
+// 注意: 配置中设置 skip-cost: true 时不计算解码得分，此时不能请求质量分数
 FFI_PLUGIN_EXPORT int bergamot_load_model(const char* cfg, const char* key);
 
+// 从单文件模型包（.bgtb，由 bergamot-bundle 工具生成）加载模型到缓存
+// 映射整个文件读取权重、词表、shortlist 与预解析配置，不再逐个打开文件，也无需解析 YAML
+// path: 模型包路径
+// key: 模型缓存键
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_load_model_bundle(const char* path, const char* key);
+
+// 替换 key 下已加载的模型（例如更新到新版本），不中断翻译；key 不存在时等同于加载
+// 新模型在后台构造，期间请求照常使用旧模型；构造完成后原子换入，之后的请求使用新模型。
+// 进行中的请求在旧模型上完成，旧模型在最后一个请求结束时释放。构造失败时旧模型保持不变
+// 参数与 bergamot_load_model / bergamot_load_model_bundle 相同
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_replace_model(const char* cfg, const char* key);
+FFI_PLUGIN_EXPORT int bergamot_replace_model_bundle(const char* path, const char* key);
+
+// 设置预处理权重缓存（默认关闭）
+// 启用后，首次加载 intgemm 模型时把按当前 CPU 指令集重排好的权重写入缓存文件，
+// 之后加载直接使用缓存，跳过加载期的权重重排。只影响之后加载的模型。
+// enabled: 1 启用, 0 禁用
+// cache_dir: 缓存目录（可为NULL，表示写在模型文件旁边）
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_set_weight_cache(int enabled, const char* cache_dir);
+
 // 批量翻译
 // inputs: 输入字符串数组
 // input_count: 输入字符串数量
@@ -72,6 +284,45 @@ FFI_PLUGIN_EXPORT int bergamot_pivot_multiple(
     int* output_count
 );
 
+// 多目标枢轴翻译：源语言 -> 中间语言只翻译一次，再并行翻译到每个目标语言
+// source_key: 第一个模型缓存键（源语言 -> 中间语言）
+// target_keys: 第二跳模型缓存键数组（中间语言 -> 各目标语言）
+// target_count: 目标模型数量
+// inputs: 输入字符串数组
+// input_count: 输入字符串数量
+// outputs: 输出字符串数组，共 target_count * input_count 个，
+//          第 t 个目标的第 i 个输入位于 outputs[t * input_count + i]
+// output_count: 输出字符串数量
+// 返回: 0 成功, 非0 失败
+// 注意: outputs 需要调用 bergamot_free_string_array 释放
+FFI_PLUGIN_EXPORT int bergamot_pivot_fan_out(
+    const char* source_key,
+    const char** target_keys,
+    int target_count,
+    const char** inputs,
+    int input_count,
+    char*** outputs,
+    int* output_count
+);
+
+// 批量翻译（连续缓冲区格式）
+// 输入、输出均为依次相连、各以 '\0' 结尾的 UTF-8 字符串，整批只需一次复制即可跨线程/isolate 传递；
+// 输出条数与输入相同，译文中的 '\0' 被去掉
+// key: 模型缓存键（枢轴翻译时为源语言 -> 中间语言）
+// pivot_key: 第二个模型缓存键（中间语言 -> 目标语言），直接翻译时为 NULL
+// inputs / input_bytes: 输入缓冲区及其字节数（含结尾的 '\0'）
+// outputs / output_bytes: 输出缓冲区及其字节数，顺序与输入对应
+// 返回: 0 成功, 非0 失败
+// 注意: outputs 需要调用 bergamot_free_string 释放
+FFI_PLUGIN_EXPORT int bergamot_translate_packed(
+    const char* key,
+    const char* pivot_key,
+    const char* inputs,
+    int64_t input_bytes,
+    char** outputs,
+    int64_t* output_bytes
+);
+
 // 语言检测
 // text: 待检测文本
 // hint: 语言提示（可选，可为NULL）
@@ -83,14 +334,107 @@ FFI_PLUGIN_EXPORT int bergamot_detect_language(
     BergamotDetectionResult* result
 );
 
+// 查询运行时检测到的 CPU 特性及选用的矩阵乘法路径
+// 库按通用基线编译，intgemm/ruy 在运行时按 CPU 选择 SSSE3/AVX2/AVX512/NEON 内核
+// info: 结果结构体指针
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_get_cpu_info(BergamotCpuInfo* info);
+
+// 创建增量翻译会话
+// 每次提交整篇文本，只重新翻译与上一版本不同的句子，其余句子沿用已有译文
+// key: 模型缓存键（枢轴翻译时为源语言 -> 中间语言）
+// pivot_key: 第二个模型缓存键（中间语言 -> 目标语言），直接翻译时为 NULL
+// session: 输出会话句柄，进程内有效
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_session_create(const char* key, const char* pivot_key, int64_t* session);
+
+// 提交文本的新版本
+// output: 整篇译文（调用者需要调用 bergamot_free_string 释放）
+// translated_sentences: 本次实际解码的句子数（可为 NULL）
+// 同一会话的多次提交按顺序执行
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_session_update(int64_t session, const char* text, char** output, int* translated_sentences);
+
+// 销毁会话
+FFI_PLUGIN_EXPORT void bergamot_session_destroy(int64_t session);
+
+// 连接本地翻译守护进程（bergamot-daemon），进入客户端模式
+// 之后加载/替换模型（bergamot_load_model* / bergamot_replace_model*）以及纯文本翻译（含枢轴、文件、会话）
+// 都转发给守护进程执行，多个进程共享其中常驻的一份模型；模型配置中的路径按守护进程解析。
+// 结构化结果（bergamot_translate_detailed）仍只使用本进程加载的模型。
+// 仅 Linux、macOS 可用
+// socket_path: 守护进程监听的 Unix 域套接字路径
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_connect_daemon(const char* socket_path);
+
+// 断开守护进程，恢复在本进程内加载和翻译
+FFI_PLUGIN_EXPORT void bergamot_disconnect_daemon(void);
+
 // 清理资源（释放所有模型和服务）
 FFI_PLUGIN_EXPORT void bergamot_cleanup(void);
 
+// 批量翻译并返回结构化结果（质量分数、对齐、句子映射）
+// inputs: 输入字符串数组
+// input_count: 输入字符串数量
+// key: 模型缓存键
+// options: BERGAMOT_RESULT_* 按位组合；0 时与 bergamot_translate_multiple 代价相同
+//          BERGAMOT_RESULT_HTML 时字节区间相对于带标签的原文/译文
+// alignment_threshold: 只返回概率不低于该值的对齐点（仅 BERGAMOT_RESULT_ALIGNMENT）
+// result: 输出结果（整个结果位于一块内存中）
+// 返回: 0 成功, 非0 失败
+// 注意: result 需要调用 bergamot_free_translation_result 释放
+FFI_PLUGIN_EXPORT int bergamot_translate_detailed(
+    const char** inputs,
+    int input_count,
+    const char* key,
+    int options,
+    float alignment_threshold,
+    BergamotTranslationResult** result
+);
+
+// 翻译文本文件：每个非空行作为一条输入，空行与换行符原样保留
+// 流式读取并分块翻译，按输入顺序写出，读取/解码/写出重叠进行
+// in_path: 输入文件路径（UTF-8）
+// out_path: 输出文件路径；先写入 out_path + ".part"，完成后重命名
+// key: 模型缓存键
+// options: 选项，可为 NULL
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_translate_file(
+    const char* in_path,
+    const char* out_path,
+    const char* key,
+    const BergamotFileOptions* options
+);
+
+// 翻译 JSONL 文件：每行一条 JSON 记录，翻译其顶层字符串字段
+// 不同记录的文本一起批量翻译，按输入顺序写回，内存占用与文件大小无关
+// field: 要翻译的字段名
+// output_field: 译文写入的字段名；NULL 或空字符串时覆盖 field
+//               （记录中已有该字段时原位替换，否则追加到记录末尾）
+// 不是对象、缺少该字段或字段不是字符串的记录原样输出
+// 其余参数与 bergamot_translate_file 相同
+// 返回: 0 成功, 非0 失败
+FFI_PLUGIN_EXPORT int bergamot_translate_jsonl(
+    const char* in_path,
+    const char* out_path,
+    const char* key,
+    const char* field,
+    const char* output_field,
+    const BergamotFileOptions* options
+);
+
+// 释放结构化翻译结果
+FFI_PLUGIN_EXPORT void bergamot_free_translation_result(BergamotTranslationResult* result);
+
 // 释放字符串数组内存
-// array: 字符串数组指针
+// array: 字符串数组指针（指针表与字符串在同一块内存中，不能单独释放元素）
 // count: 数组元素数量
 FFI_PLUGIN_EXPORT void bergamot_free_string_array(char** array, int count);
 
+// 释放单个字符串内存
+// str: 由 bergamot_session_update、bergamot_translate_packed 或 bergamot_dump_trace 返回的字符串/缓冲区
+FFI_PLUGIN_EXPORT void bergamot_free_string(char* str);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,366 @@
+// bergamot-unit-tests：不依赖模型的纯文本/协议模块的单元测试
+//
+// 用法：bergamot-unit-tests
+// 覆盖 JSONL 字段读写、原样输出判定、重复折叠、文件管线的译文数量校验，
+// 以及守护进程协议对畸形消息（错误魔数、超限头部、截短的共享内存、截断负载）的拒绝和监听套接字的创建规则。
+// 任一检查失败时返回非 0。
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "daemon_protocol.h"
+#include "file_pipeline.h"
+#include "jsonl_codec.h"
+#include "passthrough_filter.h"
+#include "repetition_guard.h"
+
+#if defined(BERGAMOT_HAS_DAEMON)
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace bergamot_plugin;
+
+namespace {
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what) {
+        if (!condition) {
+            ++failures;
+            std::cerr << "FAIL: " << what << std::endl;
+        }
+    }
+
+    template <typename T>
+    std::string quoted(const T& value) {
+        std::ostringstream out;
+        out << '"' << value << '"';
+        return out.str();
+    }
+
+    // ---- JSONL ----
+
+    void testJsonlRoundTrip() {
+        JsonStringField field;
+        std::string record = R"({"id": 7, "nested": {"text": "inner"}, "text": "a\"b\\c\ndé😀"})";
+        expect(findJsonStringField(record, "text", field), "jsonl: top-level field found");
+        expect(field.value == "a\"b\\c\nd\xC3\xA9\xF0\x9F\x98\x80", "jsonl: escapes decoded, got " + quoted(field.value));
+        expect(record.substr(field.begin, field.end - field.begin).front() == '"', "jsonl: range starts at quote");
+
+        // 回写后其余内容保持原样，再次读取得到相同的值
+        std::string value = "tab\there \"quoted\" \x01 \xE4\xB8\xAD";
+        std::string updated = record;
+        expect(setJsonStringField(updated, "text", value), "jsonl: set existing field");
+        expect(updated.compare(0, field.begin, record, 0, field.begin) == 0, "jsonl: prefix preserved");
+        JsonStringField reread;
+        expect(findJsonStringField(updated, "text", reread) && reread.value == value,
+               "jsonl: round trip, got " + quoted(reread.value));
+
+        // 不存在的字段追加到末尾
+        std::string appended = R"({"id": 1})";
+        expect(setJsonStringField(appended, "out", "x\ny"), "jsonl: append field");
+        expect(findJsonStringField(appended, "out", reread) && reread.value == "x\ny", "jsonl: appended field readable");
+        expect(findJsonStringField(appended, "id", reread) == false, "jsonl: number field is not a string");
+
+        // 只匹配顶层键；非对象与损坏的记录
+        expect(!findJsonStringField(R"({"nested": {"only": "x"}})", "only", field), "jsonl: nested key ignored");
+        expect(!findJsonStringField(R"(["text", "x"])", "text", field), "jsonl: array record rejected");
+        expect(!findJsonStringField(R"({"text": "unterminated)", "text", field), "jsonl: unterminated string rejected");
+        std::string notObject = "\"text\"";
+        expect(!setJsonStringField(notObject, "text", "x"), "jsonl: set on non-object rejected");
+
+        std::string encoded = encodeJsonString(std::string("\"\\\n\r\t\x1f", 6));
+        expect(encoded == R"("\"\\\n\r\t\u001f")", "jsonl: encode escapes, got " + encoded);
+    }
+
+    // ---- 原样输出判定 ----
+
+    void testVerbatimClassification() {
+        for (const char* text : {"12345", "3.14", "-42", "https://example.com/a?b=c", "user@example.com",
+                                 "d41d8cd98f00b204e9800998ecf8427e"}) {
+            expect(isVerbatimText(text), std::string("verbatim: ") + quoted(text));
+        }
+        // 括号、分号、下划线、标签不代表代码，这些都要翻译
+        for (const char* text : {"Hello world", "The price is 5 dollars.", "Visit https://example.com today",
+                                 "(Optional)", "[Beta]", "(see above)", "Hello;", "user_name", "<b>Hello</b>"}) {
+            expect(!isVerbatimText(text), std::string("not verbatim: ") + quoted(text));
+        }
+
+        MaskedText masked = maskVerbatimSpans("Mail user@example.com now");
+        expect(masked.spans.size() == 1 && masked.spans[0] == "user@example.com", "mask: email span");
+        std::string restored;
+        expect(restoreVerbatimSpans(masked, masked.text, restored) && restored == "Mail user@example.com now",
+               "mask: restore round trip, got " + quoted(restored));
+        expect(!restoreVerbatimSpans(masked, "Mail now", restored), "mask: missing placeholder rejected");
+    }
+
+    // ---- 重复折叠 ----
+
+    void testRepeatFolding() {
+        expect(collapseRepeats("ha ha ha ha ha ha", 2, false) == "ha ha", "fold: single word");
+        expect(collapseRepeats("go on go on go on go on", 2, false) == "go on go on", "fold: two-word phrase");
+        expect(collapseRepeats("ha ha ha ha", 0, true) == "ha ha ha ha", "fold: limit 0 disables");
+        expect(collapseRepeats("1 1 1 1 1 1", 2, false) == "1 1 1 1 1 1", "fold: numbers kept");
+        expect(collapseRepeats("---- ---- ---- ----", 1, false) == "---- ---- ---- ----", "fold: separators kept");
+        expect(collapseRepeats("ha ha ha ha", 8, false) == "ha ha ha ha", "fold: below limit unchanged");
+        expect(collapseRepeats(std::string(20, 'a'), 2, true) == std::string(8, 'a'), "fold: letter run truncated");
+        expect(collapseRepeats(std::string(20, 'a'), 2, false) == std::string(20, 'a'), "fold: letter run kept");
+    }
+
+    // ---- 文件管线 ----
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    void testFilePipelineCounts() {
+        std::string inPath = "bergamot-unit-tests-input.txt";
+        std::string outPath = "bergamot-unit-tests-output.txt";
+        {
+            std::ofstream in(inPath, std::ios::binary);
+            in << "one\r\n\ntwo\nthree";
+        }
+        FilePipelineOptions options;
+        auto upper = [](std::vector<std::string>&& inputs) {
+            for (auto& s : inputs) {
+                for (auto& c : s) {
+                    c = (char)std::toupper((unsigned char)c);
+                }
+            }
+            return std::move(inputs);
+        };
+        translateTextFile(inPath, outPath, options, upper, nullptr);
+        expect(readFile(outPath) == "ONE\r\n\nTWO\nTHREE", "pipeline: line endings preserved");
+
+        auto check = [&](const std::string& name, const TranslateBatch& translate) {
+            std::remove(outPath.c_str());
+            bool threw = false;
+            try {
+                translateTextFile(inPath, outPath, options, translate, nullptr);
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            expect(threw, "pipeline: " + name + " rejected");
+            expect(!std::ifstream(outPath) && !std::ifstream(outPath + ".part"), "pipeline: " + name + " leaves no output");
+        };
+        check("too few translations", [](std::vector<std::string>&& inputs) {
+            inputs.pop_back();
+            return std::move(inputs);
+        });
+        check("too many translations", [](std::vector<std::string>&& inputs) {
+            inputs.push_back("extra");
+            return std::move(inputs);
+        });
+        std::remove(inPath.c_str());
+        std::remove(outPath.c_str());
+    }
+
+#if defined(BERGAMOT_HAS_DAEMON)
+    // ---- 守护进程协议 ----
+
+    // 与 daemon_protocol.cpp 中的 FrameHeader 布局一致
+    struct RawHeader {
+        uint32_t magic = 0x42475444;
+        uint16_t type = kDaemonTranslate;
+        uint16_t status = 0;
+        uint32_t inlineBytes = 0;
+        uint32_t reserved = 0;
+        uint64_t sharedBytes = 0;
+    };
+
+    // 写入 bytes（可附带一个文件描述符）后关闭发送端，返回接收结果
+    bool receiveRaw(const std::string& bytes, int passFd = -1) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            expect(false, "daemon: socketpair");
+            return false;
+        }
+        iovec iov;
+        iov.iov_base = const_cast<char*>(bytes.data());
+        iov.iov_len = bytes.size();
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        if (passFd >= 0) {
+            std::memset(control, 0, sizeof(control));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &passFd, sizeof(int));
+        }
+        bool sent = sendmsg(fds[0], &msg, 0) == (ssize_t)bytes.size();
+        close(fds[0]);
+        DaemonMessage message;
+        bool ok = sent && receiveDaemonMessage(fds[1], message);
+        close(fds[1]);
+        return ok;
+    }
+
+    std::string frame(const RawHeader& header, const std::string& payload = std::string()) {
+        return std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + payload;
+    }
+
+    std::string stringList(uint32_t count, const std::vector<std::string>& items) {
+        std::string out(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const auto& item : items) {
+            uint32_t length = (uint32_t)item.size();
+            out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            out += item;
+        }
+        return out;
+    }
+
+    void testDaemonFrames() {
+        // 正常消息：内联与共享内存两种路径
+        for (size_t size : {size_t(16), kDaemonSharedThreshold * 2}) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                expect(false, "daemon: socketpair");
+                return;
+            }
+            DaemonMessage out;
+            out.type = kDaemonTranslate;
+            out.strings = {"key", "", std::string(size, 'x')};
+            DaemonMessage in;
+            bool ok = sendDaemonMessage(fds[0], out) && receiveDaemonMessage(fds[1], in);
+            expect(ok && in.type == out.type && in.strings == out.strings,
+                   "daemon: round trip of " + std::to_string(size) + " bytes");
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        std::string payload = stringList(1, {"ok"});
+        RawHeader header;
+        header.inlineBytes = (uint32_t)payload.size();
+        expect(receiveRaw(frame(header, payload)), "daemon: hand-built frame accepted");
+
+        RawHeader badMagic = header;
+        badMagic.magic = 0;
+        expect(!receiveRaw(frame(badMagic, payload)), "daemon: bad magic rejected");
+
+        RawHeader oversized;
+        oversized.inlineBytes = (uint32_t)kDaemonMaxInlineBytes + 1;
+        expect(!receiveRaw(frame(oversized)), "daemon: oversized inline header rejected");
+
+        RawHeader truncated;
+        truncated.inlineBytes = 100;
+        expect(!receiveRaw(frame(truncated, "short")), "daemon: truncated inline payload rejected");
+
+        std::string lying = stringList(5, {"a"});
+        RawHeader badList;
+        badList.inlineBytes = (uint32_t)lying.size();
+        expect(!receiveRaw(frame(badList, lying)), "daemon: string count beyond payload rejected");
+
+        RawHeader missingFd;
+        missingFd.sharedBytes = 1024;
+        expect(!receiveRaw(frame(missingFd)), "daemon: shared size without descriptor rejected");
+
+        RawHeader hugeShared;
+        hugeShared.sharedBytes = (uint64_t)kDaemonMaxSharedBytes + 1;
+        expect(!receiveRaw(frame(hugeShared)), "daemon: oversized shared header rejected");
+
+#if defined(__linux__)
+        // 伪造的共享内存：实际大小小于声明的大小，且未封住截短
+        int shortFd = memfd_create("bergamot-unit-tests", MFD_CLOEXEC);
+        if (shortFd >= 0 && ftruncate(shortFd, 8) == 0) {
+            RawHeader forged;
+            forged.sharedBytes = 1 << 20;
+            expect(!receiveRaw(frame(forged), shortFd), "daemon: short shared buffer rejected");
+
+            RawHeader unsealed;
+            unsealed.sharedBytes = 8;
+            expect(!receiveRaw(frame(unsealed), shortFd), "daemon: unsealed shared buffer rejected");
+        } else {
+            expect(false, "daemon: memfd_create");
+        }
+        if (shortFd >= 0) {
+            close(shortFd);
+        }
+#endif
+    }
+
+    bool throwsOnListen(const std::string& path) {
+        try {
+            close(listenDaemonSocket(path));
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    }
+
+    void testDaemonSocket() {
+        std::string path = "bergamot-unit-tests.sock";
+        unlink(path.c_str());
+
+        // 普通文件不会被删除
+        {
+            std::ofstream file(path);
+            file << "keep";
+        }
+        expect(throwsOnListen(path) && readFile(path) == "keep", "socket: regular file not replaced");
+        unlink(path.c_str());
+
+        int listener = listenDaemonSocket(path);
+        struct stat st;
+        expect(stat(path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600, "socket: created with mode 0600");
+
+        // 已有守护进程在监听时拒绝启动
+        expect(throwsOnListen(path), "socket: live daemon not replaced");
+
+        int client = connectDaemonSocket(path);
+        int accepted = accept(listener, nullptr, nullptr);
+        expect(accepted >= 0 && daemonPeerIsOwner(accepted), "socket: same-user peer accepted");
+        close(client);
+        if (accepted >= 0) {
+            close(accepted);
+        }
+
+        // 监听者退出后留下的套接字视为残留，可以重新监听
+        close(listener);
+        bool replaced = !throwsOnListen(path);
+        expect(replaced, "socket: stale socket replaced");
+        unlink(path.c_str());
+    }
+#endif
+}
+
+int main() {
+    const std::vector<std::pair<const char*, std::function<void()>>> tests = {
+        {"jsonl", testJsonlRoundTrip},
+        {"verbatim", testVerbatimClassification},
+        {"repeats", testRepeatFolding},
+        {"file pipeline", testFilePipelineCounts},
+#if defined(BERGAMOT_HAS_DAEMON)
+        {"daemon frames", testDaemonFrames},
+        {"daemon socket", testDaemonSocket},
+#endif
+    };
+    for (const auto& test : tests) {
+        int before = failures;
+        try {
+            test.second();
+        } catch (const std::exception& e) {
+            expect(false, std::string(test.first) + ": unexpected exception: " + e.what());
+        }
+        std::cout << (failures == before ? "ok   " : "FAIL ") << test.first << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
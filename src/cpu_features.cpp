@@ -0,0 +1,110 @@
+#include "cpu_features.h"
+
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define BERGAMOT_X86_CPUID 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define BERGAMOT_X86_CPUID 1
+#endif
+
+#ifdef USE_INTGEMM
+#include "intgemm/intgemm.h"
+#endif
+
+namespace bergamot_plugin {
+
+namespace {
+#ifdef BERGAMOT_X86_CPUID
+    // regs 依次为 eax、ebx、ecx、edx；leaf 超出 CPU 支持的范围时返回 false
+    bool cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, (int)(leaf & 0x80000000u));
+        if ((unsigned int)info[0] < leaf) {
+            return false;
+        }
+        __cpuidex(info, (int)leaf, (int)subleaf);
+        for (int i = 0; i < 4; ++i) {
+            regs[i] = (unsigned int)info[i];
+        }
+        return true;
+#else
+        return __get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]) != 0;
+#endif
+    }
+
+    uint64_t readXcr0() {
+#ifdef _MSC_VER
+        return (uint64_t)_xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((uint64_t)edx << 32) | eax;
+#endif
+    }
+#endif
+
+    CpuFeatures detect() {
+        CpuFeatures features;
+#ifdef BERGAMOT_X86_CPUID
+        unsigned int regs[4];
+        if (!cpuid(1, 0, regs)) {
+            return features;
+        }
+        unsigned int ecx = regs[2];
+        features.ssse3 = (ecx & (1u << 9)) != 0;
+        features.sse41 = (ecx & (1u << 19)) != 0;
+
+        // AVX 系列还需要操作系统保存对应寄存器状态（OSXSAVE + XCR0）
+        bool osxsave = (ecx & (1u << 27)) != 0;
+        uint64_t xcr0 = osxsave ? readXcr0() : 0;
+        bool osAvx = (xcr0 & 0x6) == 0x6;
+        bool osAvx512 = (xcr0 & 0xe6) == 0xe6;
+
+        if (cpuid(7, 0, regs)) {
+            features.avx2 = osAvx && (regs[1] & (1u << 5)) != 0;
+            features.avx512bw = osAvx512 && (regs[1] & (1u << 30)) != 0;
+            features.avx512vnni = osAvx512 && (regs[2] & (1u << 11)) != 0;
+        }
+#elif defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+        features.neon = true;
+#endif
+        return features;
+    }
+}
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+const char* intgemmIsaName() {
+#ifdef USE_INTGEMM
+    switch (intgemm::kCPU) {
+        case intgemm::CPUType::AVX512VNNI: return "avx512vnni";
+        case intgemm::CPUType::AVX512BW: return "avx512bw";
+        case intgemm::CPUType::AVX2: return "avx2";
+        case intgemm::CPUType::SSSE3: return "ssse3";
+        case intgemm::CPUType::SSE2: return "sse2";
+        default: return "unsupported";
+    }
+#else
+    return "none";
+#endif
+}
+
+const char* gemmPathName() {
+#ifdef USE_INTGEMM
+    static const std::string name = std::string("intgemm-") + intgemmIsaName();
+    return name.c_str();
+#else
+    return cpuFeatures().neon ? "ruy-neon" : "ruy";
+#endif
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,32 @@
+#ifndef BERGAMOT_CPU_FEATURES_H
+#define BERGAMOT_CPU_FEATURES_H
+
+// 运行时 CPU 特性检测
+//
+// 库本身按通用基线编译（x86-64 + SSE4.1 / ARMv8），矩阵乘法的具体内核在运行时选择：
+// intgemm 根据 CPUID 在 SSSE3/AVX2/AVX512BW/AVX512VNNI 之间分派，
+// ruy 同样按检测结果选择 AVX2/AVX512/NEON 路径。这里汇总检测结果及最终选用的路径。
+namespace bergamot_plugin {
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool ssse3 = false;
+    bool avx2 = false;
+    bool avx512bw = false;
+    bool avx512vnni = false;
+    bool neon = false;
+};
+
+// 检测当前 CPU（及操作系统）支持的指令集，结果在首次调用后缓存
+const CpuFeatures& cpuFeatures();
+
+// 当前 CPU 上 intgemm 选用的指令集名称；未启用 intgemm 时返回 "none"
+// 可在进程启动前通过环境变量 INTGEMM_CPUID（AVX512VNNI/AVX512BW/AVX2/SSSE3/SSE2）限制
+const char* intgemmIsaName();
+
+// int8 矩阵乘法实际使用的路径，例如 "intgemm-avx2"、"ruy-neon"
+const char* gemmPathName();
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_CPU_FEATURES_H
@@ -0,0 +1,133 @@
+#include "daemon_client.h"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+#include "daemon_protocol.h"
+
+#if defined(BERGAMOT_HAS_DAEMON)
+#include <unistd.h>
+#endif
+
+namespace bergamot_plugin {
+
+#if defined(BERGAMOT_HAS_DAEMON)
+
+namespace {
+    std::mutex daemon_mutex;
+    std::string daemon_path;                // 为空表示未连接
+    std::vector<int> daemon_idle;           // 空闲连接
+    uint64_t daemon_generation = 0;         // 每次连接/断开递增，旧连接归还时直接关闭
+    std::atomic<bool> daemon_connected{false};
+
+    void closeIdle() {
+        for (int fd : daemon_idle) {
+            close(fd);
+        }
+        daemon_idle.clear();
+    }
+}
+
+void connectDaemon(const std::string& path) {
+    int fd = connectDaemonSocket(path);
+    DaemonMessage ping;
+    ping.type = kDaemonPing;
+    DaemonMessage reply;
+    if (!sendDaemonMessage(fd, ping) || !receiveDaemonMessage(fd, reply) || reply.status != 0) {
+        close(fd);
+        throw std::runtime_error("Daemon at " + path + " did not respond");
+    }
+
+    std::lock_guard<std::mutex> lock(daemon_mutex);
+    closeIdle();
+    daemon_path = path;
+    daemon_idle.push_back(fd);
+    ++daemon_generation;
+    daemon_connected.store(true);
+}
+
+void disconnectDaemon() {
+    std::lock_guard<std::mutex> lock(daemon_mutex);
+    closeIdle();
+    daemon_path.clear();
+    ++daemon_generation;
+    daemon_connected.store(false);
+}
+
+bool daemonConnected() {
+    return daemon_connected.load(std::memory_order_relaxed);
+}
+
+void trimDaemonConnections() {
+    std::lock_guard<std::mutex> lock(daemon_mutex);
+    closeIdle();
+}
+
+std::vector<std::string> daemonCall(uint16_t type, std::vector<std::string>&& args) {
+    int fd = -1;
+    uint64_t generation;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(daemon_mutex);
+        if (daemon_path.empty()) {
+            throw std::runtime_error("Not connected to a daemon");
+        }
+        generation = daemon_generation;
+        path = daemon_path;
+        if (!daemon_idle.empty()) {
+            fd = daemon_idle.back();
+            daemon_idle.pop_back();
+        }
+    }
+    if (fd < 0) {
+        fd = connectDaemonSocket(path);
+    }
+
+    DaemonMessage request;
+    request.type = type;
+    request.strings = std::move(args);
+    DaemonMessage reply;
+    if (!sendDaemonMessage(fd, request) || !receiveDaemonMessage(fd, reply)) {
+        close(fd);
+        throw std::runtime_error("Lost connection to daemon at " + path);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(daemon_mutex);
+        if (generation == daemon_generation) {
+            daemon_idle.push_back(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    if (reply.status != 0) {
+        throw std::runtime_error("Daemon error: " + (reply.strings.empty() ? std::string("unknown") : reply.strings.front()));
+    }
+    return std::move(reply.strings);
+}
+
+#else
+
+void connectDaemon(const std::string&) {
+    throw std::runtime_error("Daemon client mode is not supported on this platform");
+}
+
+void disconnectDaemon() {}
+
+bool daemonConnected() {
+    return false;
+}
+
+void trimDaemonConnections() {}
+
+std::vector<std::string> daemonCall(uint16_t, std::vector<std::string>&&) {
+    throw std::runtime_error("Daemon client mode is not supported on this platform");
+}
+
+#endif
+
+} // namespace bergamot_plugin
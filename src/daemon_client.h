@@ -0,0 +1,27 @@
+#ifndef BERGAMOT_DAEMON_CLIENT_H
+#define BERGAMOT_DAEMON_CLIENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 客户端模式
+//
+// connectDaemon 之后，加载模型与纯文本翻译请求不在本进程执行，而是转发给 bergamot-daemon。
+// 每个并发请求使用一条独立连接，空闲连接复用，守护进程一侧由同一个服务统一组批。
+namespace bergamot_plugin {
+
+// 连接并验证守护进程可用，失败时抛出异常；重复调用会切换到新的套接字
+void connectDaemon(const std::string& path);
+void disconnectDaemon();
+bool daemonConnected();
+
+// 关闭空闲连接，之后的请求按需重新连接
+void trimDaemonConnections();
+
+// 发送一个请求（DaemonRequest）并返回结果列表；守护进程报告失败或连接出错时抛出异常
+std::vector<std::string> daemonCall(uint16_t type, std::vector<std::string>&& args);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_DAEMON_CLIENT_H
@@ -0,0 +1,399 @@
+#include "daemon_protocol.h"
+
+#if defined(BERGAMOT_HAS_DAEMON)
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <atomic>
+#endif
+
+namespace bergamot_plugin {
+
+namespace {
+    constexpr uint32_t kFrameMagic = 0x42475444;   // "BGTD"
+
+    struct FrameHeader {
+        uint32_t magic;
+        uint16_t type;
+        uint16_t status;
+        uint32_t inlineBytes;
+        uint32_t reserved;
+        uint64_t sharedBytes;   // 非 0 时负载在随消息传递的共享内存中
+    };
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kSendFlags = 0;   // macOS 上改用 SO_NOSIGPIPE
+#endif
+
+    void appendU32(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    std::string encodeStrings(const std::vector<std::string>& strings) {
+        size_t bytes = sizeof(uint32_t);
+        for (const auto& s : strings) {
+            bytes += sizeof(uint32_t) + s.size();
+        }
+        std::string out;
+        out.reserve(bytes);
+        appendU32(out, (uint32_t)strings.size());
+        for (const auto& s : strings) {
+            appendU32(out, (uint32_t)s.size());
+            out += s;
+        }
+        return out;
+    }
+
+    bool decodeStrings(const char* data, size_t size, std::vector<std::string>& strings) {
+        size_t pos = 0;
+        auto readU32 = [&](uint32_t& value) {
+            if (pos + sizeof(value) > size) {
+                return false;
+            }
+            std::memcpy(&value, data + pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        };
+
+        uint32_t count = 0;
+        if (!readU32(count)) {
+            return false;
+        }
+        strings.clear();
+        strings.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length = 0;
+            if (!readU32(length) || pos + length > size) {
+                return false;
+            }
+            strings.emplace_back(data + pos, length);
+            pos += length;
+        }
+        return true;
+    }
+
+    int createSharedBuffer(size_t size) {
+        int fd = -1;
+#if defined(__linux__)
+        fd = memfd_create("bergamot-daemon", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+        // 创建后立即删除名字，只通过文件描述符访问
+        static std::atomic<uint64_t> counter{0};
+        std::string name = "/bergamot-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            shm_unlink(name.c_str());
+        }
+#endif
+        if (fd < 0) {
+            return -1;
+        }
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            return -1;
+        }
+#if defined(__linux__)
+        // 封住大小，接收方映射后发送方无法再截短（截短会让接收方访问时收到 SIGBUS）
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+            close(fd);
+            return -1;
+        }
+#endif
+        return fd;
+    }
+
+    // 共享内存的实际大小不小于声明的大小，且（Linux 上）已封住不能截短
+    bool validSharedBuffer(int fd, uint64_t bytes) {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < 0 || (uint64_t)st.st_size < bytes) {
+            return false;
+        }
+#if defined(__linux__)
+        int seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || (seals & F_SEAL_SHRINK) == 0) {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = send(fd, data, size, kSendFlags);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= (size_t)n;
+        }
+        return true;
+    }
+
+    bool readAll(int fd, char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = recv(fd, data, size, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            size -= (size_t)n;
+        }
+        return true;
+    }
+
+    void disableSigpipe(int fd) {
+#if defined(SO_NOSIGPIPE)
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+        (void)fd;
+#endif
+    }
+
+    sockaddr_un socketAddress(const std::string& path) {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("Invalid daemon socket path: " + path);
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return addr;
+    }
+}
+
+bool sendDaemonMessage(int fd, const DaemonMessage& message) {
+    std::string payload = encodeStrings(message.strings);
+    if (payload.size() > kDaemonMaxSharedBytes) {
+        return false;
+    }
+
+    FrameHeader header{};
+    header.magic = kFrameMagic;
+    header.type = message.type;
+    header.status = message.status;
+
+    int sharedFd = -1;
+    if (payload.size() >= kDaemonSharedThreshold) {
+        sharedFd = createSharedBuffer(payload.size());
+    }
+    if (sharedFd >= 0) {
+        void* map = mmap(nullptr, payload.size(), PROT_READ | PROT_WRITE, MAP_SHARED, sharedFd, 0);
+        if (map == MAP_FAILED) {
+            close(sharedFd);
+            sharedFd = -1;
+        } else {
+            std::memcpy(map, payload.data(), payload.size());
+            munmap(map, payload.size());
+            header.sharedBytes = payload.size();
+        }
+    }
+    // 共享内存不可用时退回内联
+    if (sharedFd < 0) {
+        if (payload.size() > kDaemonMaxInlineBytes) {
+            return false;
+        }
+        header.inlineBytes = (uint32_t)payload.size();
+    }
+
+    iovec iov;
+    iov.iov_base = &header;
+    iov.iov_len = sizeof(header);
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (sharedFd >= 0) {
+        std::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &sharedFd, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &msg, kSendFlags);
+    } while (sent < 0 && errno == EINTR);
+    if (sharedFd >= 0) {
+        close(sharedFd);
+    }
+    if (sent < 0) {
+        return false;
+    }
+    // 文件描述符随第一个字节送达，其余头部和内联负载按普通字节流发送
+    if ((size_t)sent < sizeof(header) &&
+        !writeAll(fd, reinterpret_cast<const char*>(&header) + sent, sizeof(header) - (size_t)sent)) {
+        return false;
+    }
+    return header.inlineBytes == 0 || writeAll(fd, payload.data(), payload.size());
+}
+
+bool receiveDaemonMessage(int fd, DaemonMessage& message) {
+    FrameHeader header{};
+    iovec iov;
+    iov.iov_base = &header;
+    iov.iov_len = sizeof(header);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(fd, &msg, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) {
+        return false;
+    }
+
+    int sharedFd = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&sharedFd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    bool ok = (size_t)received == sizeof(header) ||
+              readAll(fd, reinterpret_cast<char*>(&header) + received, sizeof(header) - (size_t)received);
+    ok = ok && header.magic == kFrameMagic && (header.sharedBytes == 0) == (sharedFd < 0) &&
+         header.inlineBytes <= kDaemonMaxInlineBytes && header.sharedBytes <= kDaemonMaxSharedBytes &&
+         (sharedFd < 0 || validSharedBuffer(sharedFd, header.sharedBytes));
+
+    if (ok) {
+        message.type = header.type;
+        message.status = header.status;
+        if (sharedFd >= 0) {
+            void* map = mmap(nullptr, (size_t)header.sharedBytes, PROT_READ, MAP_SHARED, sharedFd, 0);
+            if (map == MAP_FAILED) {
+                ok = false;
+            } else {
+                ok = decodeStrings(static_cast<const char*>(map), (size_t)header.sharedBytes, message.strings);
+                munmap(map, (size_t)header.sharedBytes);
+            }
+        } else {
+            std::string payload(header.inlineBytes, '\0');
+            ok = readAll(fd, &payload[0], payload.size()) && decodeStrings(payload.data(), payload.size(), message.strings);
+        }
+    }
+    if (sharedFd >= 0) {
+        close(sharedFd);
+    }
+    return ok;
+}
+
+int connectDaemonSocket(const std::string& path) {
+    sockaddr_un addr = socketAddress(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Cannot connect to daemon at " + path + ": " + std::strerror(error));
+    }
+    disableSigpipe(fd);
+    return fd;
+}
+
+int listenDaemonSocket(const std::string& path) {
+    sockaddr_un addr = socketAddress(path);
+
+    // 只删除无人监听的残留套接字：普通文件或仍在服务的守护进程都不能被顶替
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            throw std::runtime_error("Refusing to replace " + path + ": not a socket");
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe < 0) {
+            throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+        }
+        int connected = connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        int error = errno;
+        close(probe);
+        if (connected == 0) {
+            throw std::runtime_error("A daemon is already listening on " + path);
+        }
+        if (error != ECONNREFUSED) {
+            throw std::runtime_error("Cannot probe " + path + ": " + std::strerror(error));
+        }
+        unlink(path.c_str());
+    } else if (errno != ENOENT) {
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(errno));
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+    }
+    // 套接字文件从创建起只有所有者可以连接
+    mode_t previousMask = umask(0077);
+    int bound = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    int error = errno;
+    umask(previousMask);
+    if (bound == 0 && chmod(path.c_str(), 0600) != 0) {
+        bound = -1;
+        error = errno;
+    }
+    if (bound == 0 && listen(fd, SOMAXCONN) != 0) {
+        bound = -1;
+        error = errno;
+    }
+    if (bound != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot listen on " + path + ": " + std::strerror(error));
+    }
+    return fd;
+}
+
+bool daemonPeerIsOwner(int fd) {
+    uid_t uid;
+#if defined(SO_PEERCRED)
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        return false;
+    }
+    uid = credentials.uid;
+#else
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0) {
+        return false;
+    }
+#endif
+    return uid == geteuid();
+}
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_HAS_DAEMON
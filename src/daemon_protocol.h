@@ -0,0 +1,69 @@
+#ifndef BERGAMOT_DAEMON_PROTOCOL_H
+#define BERGAMOT_DAEMON_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 本地翻译守护进程（bergamot-daemon）与客户端之间的协议
+//
+// 多个进程各自加载同一模型会各占一份权重内存。守护进程持有模型与翻译服务，
+// 客户端通过 Unix 域套接字发送请求，所有进程共享一份常驻模型和同一个批处理池。
+//
+// 每条消息为固定长度的 FrameHeader，后接 inlineBytes 字节的内联负载；
+// 负载较大时改放在共享内存中（memfd / shm_open 创建，通过 SCM_RIGHTS 传递文件描述符），
+// 接收方直接 mmap 读取，批量文本不经过套接字复制。
+// 负载统一编码为字符串列表：uint32 个数，随后每项为 uint32 长度 + 字节。
+#if defined(__APPLE__)
+#include <TargetConditionals.h>
+#endif
+
+// Windows、Android、iOS 上不提供（没有 SCM_RIGHTS/共享内存，或应用沙箱不允许）
+#if !defined(_WIN32) && !defined(__ANDROID__) && !(defined(__APPLE__) && TARGET_OS_IPHONE)
+#define BERGAMOT_HAS_DAEMON 1
+#endif
+
+namespace bergamot_plugin {
+
+enum DaemonRequest : uint16_t {
+    kDaemonPing = 0,
+    kDaemonLoadModel = 1,       // [cfg, key]
+    kDaemonLoadBundle = 2,      // [path, key]
+    kDaemonTranslate = 3,       // [key, "html" 或 "", inputs...]
+    kDaemonPivot = 4,           // [firstKey, secondKey, inputs...]
+    kDaemonReplaceModel = 5,    // [cfg, key]
+    kDaemonReplaceBundle = 6,   // [path, key]
+};
+
+// 回复的 status：0 成功，负载为结果列表；否则负载为 [错误信息]
+struct DaemonMessage {
+    uint16_t type = 0;
+    uint16_t status = 0;
+    std::vector<std::string> strings;
+};
+
+// 超过该大小的负载放入共享内存
+constexpr size_t kDaemonSharedThreshold = 64 * 1024;
+
+// 单条消息负载的上限，接收方据此拒绝异常的头部，不按对方声明的大小分配或映射内存。
+// 内联负载只在共享内存不可用时才会很大
+constexpr size_t kDaemonMaxInlineBytes = 64 * 1024 * 1024;
+constexpr size_t kDaemonMaxSharedBytes = (size_t)1 << 30;
+
+// 发送/接收一条完整消息；连接关闭或出错时返回 false
+bool sendDaemonMessage(int fd, const DaemonMessage& message);
+bool receiveDaemonMessage(int fd, DaemonMessage& message);
+
+// 连接到守护进程套接字，失败时抛出异常
+int connectDaemonSocket(const std::string& path);
+// 创建监听套接字，套接字文件权限为 0600（只有所有者可以连接）。
+// path 上已有的套接字无人监听时视为残留并删除；已有守护进程在监听或 path 不是套接字时抛出异常
+int listenDaemonSocket(const std::string& path);
+
+// 连接对方与本进程属于同一用户（Linux 上为 SO_PEERCRED，macOS 上为 getpeereid）
+bool daemonPeerIsOwner(int fd);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_DAEMON_PROTOCOL_H
@@ -0,0 +1,196 @@
+#include "file_pipeline.h"
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+
+#include "jsonl_codec.h"
+
+namespace bergamot_plugin {
+
+namespace {
+    struct Line {
+        std::string raw;
+        bool hasText = false;   // 是否包含待翻译文本
+        bool crlf = false;
+        bool newline = true;    // 文件最后一行可能没有换行
+    };
+
+    struct Chunk {
+        std::vector<Line> lines;
+        std::vector<std::string> texts;     // 取出的待翻译文本，提交翻译时移走
+        int64_t endOffset = 0;  // 本块结束时的输入字节偏移，用于进度
+        std::future<std::vector<std::string>> translations;
+    };
+
+    // 读取一块：至少一行，累计达到 chunkBytes 后在行边界结束
+    bool readChunk(std::ifstream& in, size_t chunkBytes, const LineFormat& format, int64_t& offset, Chunk& chunk) {
+        size_t bytes = 0;
+        std::string text;
+        while (bytes < chunkBytes && std::getline(in, text)) {
+            Line line;
+            line.newline = !in.eof();
+            offset += (int64_t)text.size() + (line.newline ? 1 : 0);
+            bytes += text.size() + 1;
+            if (!text.empty() && text.back() == '\r') {
+                text.pop_back();
+                line.crlf = true;
+            }
+            std::string extracted;
+            line.hasText = format.extract(text, extracted);
+            if (line.hasText) {
+                chunk.texts.push_back(std::move(extracted));
+            }
+            line.raw = std::move(text);
+            chunk.lines.push_back(std::move(line));
+        }
+        chunk.endOffset = offset;
+        return !chunk.lines.empty();
+    }
+
+    void startChunk(Chunk& chunk, const TranslateBatch& translate) {
+        std::vector<std::string> inputs = std::move(chunk.texts);
+        chunk.translations = std::async(std::launch::async, [&translate, inputs = std::move(inputs)]() mutable {
+            if (inputs.empty()) {
+                return std::vector<std::string>();
+            }
+            return translate(std::move(inputs));
+        });
+    }
+
+    void writeChunk(std::ofstream& out, const LineFormat& format, Chunk& chunk) {
+        std::vector<std::string> translations = chunk.translations.get();
+        size_t next = 0;
+        for (auto& line : chunk.lines) {
+            if (line.hasText) {
+                if (next >= translations.size()) {
+                    throw std::runtime_error("Translation count does not match input");
+                }
+                out << format.assemble(std::move(line.raw), std::move(translations[next++]));
+            } else {
+                out << line.raw;
+            }
+            if (line.crlf) {
+                out << '\r';
+            }
+            if (line.newline) {
+                out << '\n';
+            }
+        }
+        // 多出的译文同样说明与输入错位
+        if (next != translations.size()) {
+            throw std::runtime_error("Translation count does not match input");
+        }
+    }
+}
+
+void translateLineFile(const std::string& inPath, const std::string& outPath,
+                       const FilePipelineOptions& options, const LineFormat& format,
+                       const TranslateBatch& translate, const ProgressCallback& progress) {
+    std::ifstream in(inPath, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open input file: " + inPath);
+    }
+    in.seekg(0, std::ios::end);
+    int64_t total = (int64_t)in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    std::string partPath = outPath + ".part";
+    std::ofstream out(partPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open output file: " + partPath);
+    }
+
+    size_t maxInFlight = options.maxInFlight > 0 ? options.maxInFlight : 1;
+    std::deque<Chunk> inFlight;
+    int64_t offset = 0;
+    try {
+        bool more = true;
+        while (more || !inFlight.empty()) {
+            // 先把翻译队列填满，再写出最早的一块
+            while (more && inFlight.size() < maxInFlight) {
+                Chunk chunk;
+                more = readChunk(in, options.chunkBytes, format, offset, chunk);
+                if (more) {
+                    startChunk(chunk, translate);
+                    inFlight.push_back(std::move(chunk));
+                }
+            }
+            if (inFlight.empty()) {
+                break;
+            }
+
+            writeChunk(out, format, inFlight.front());
+            int64_t done = inFlight.front().endOffset;
+            inFlight.pop_front();
+            if (!out) {
+                throw std::runtime_error("Failed to write output file: " + partPath);
+            }
+            if (progress) {
+                progress(done, total);
+            }
+        }
+
+        out.close();
+#if _WIN32
+        // Windows 上 rename 不会覆盖已存在的文件
+        std::remove(outPath.c_str());
+#endif
+        if (!out || std::rename(partPath.c_str(), outPath.c_str()) != 0) {
+            throw std::runtime_error("Failed to write output file: " + outPath);
+        }
+    } catch (...) {
+        // 等待仍在翻译的块结束（它们引用了 translate），再删除临时文件
+        for (auto& chunk : inFlight) {
+            if (chunk.translations.valid()) {
+                chunk.translations.wait();
+            }
+        }
+        out.close();
+        std::remove(partPath.c_str());
+        throw;
+    }
+}
+
+void translateTextFile(const std::string& inPath, const std::string& outPath,
+                       const FilePipelineOptions& options, const TranslateBatch& translate,
+                       const ProgressCallback& progress) {
+    LineFormat format;
+    format.extract = [](const std::string& line, std::string& text) {
+        if (line.empty()) {
+            return false;
+        }
+        text = line;
+        return true;
+    };
+    format.assemble = [](std::string&&, std::string&& translation) {
+        return std::move(translation);
+    };
+    translateLineFile(inPath, outPath, options, format, translate, progress);
+}
+
+void translateJsonlFile(const std::string& inPath, const std::string& outPath,
+                        const FilePipelineOptions& options, const std::string& field,
+                        const std::string& outputField, const TranslateBatch& translate,
+                        const ProgressCallback& progress) {
+    const std::string& target = outputField.empty() ? field : outputField;
+
+    LineFormat format;
+    format.extract = [&field](const std::string& line, std::string& text) {
+        JsonStringField value;
+        if (!findJsonStringField(line, field, value) || value.value.empty()) {
+            return false;
+        }
+        text = std::move(value.value);
+        return true;
+    };
+    format.assemble = [&target](std::string&& line, std::string&& translation) {
+        setJsonStringField(line, target, translation);
+        return std::move(line);
+    };
+    translateLineFile(inPath, outPath, options, format, translate, progress);
+}
+
+} // namespace bergamot_plugin
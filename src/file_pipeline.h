@@ -0,0 +1,56 @@
+#ifndef BERGAMOT_FILE_PIPELINE_H
+#define BERGAMOT_FILE_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 大文件流式翻译
+//
+// 输入按行流式读取并按字节数切块，每块交给 translate 在独立线程上翻译，
+// 同时保持最多 maxInFlight 块在翻译中；调用线程按输入顺序等待最早的块并写出，
+// 因此读取、解码、写出三者重叠，内存占用与 chunkBytes * maxInFlight 成正比。
+namespace bergamot_plugin {
+
+// 翻译一批文本，返回顺序与输入一致；可能在多个线程上并发调用
+using TranslateBatch = std::function<std::vector<std::string>(std::vector<std::string>&&)>;
+
+// 已写出的输入字节数、输入文件总字节数；在调用线程上调用
+using ProgressCallback = std::function<void(int64_t done, int64_t total)>;
+
+struct FilePipelineOptions {
+    size_t chunkBytes = 64 * 1024;
+    size_t maxInFlight = 2;
+};
+
+// 行格式：从每行取出待翻译文本，再用译文生成输出行
+struct LineFormat {
+    // 返回 false 表示该行不翻译、原样输出
+    std::function<bool(const std::string& line, std::string& text)> extract;
+    std::function<std::string(std::string&& line, std::string&& translation)> assemble;
+};
+
+// 按 format 逐行翻译；换行符（\n 或 \r\n）原样保留。
+// 先写入 outPath + ".part"，成功后再重命名为 outPath；失败时抛出异常并删除临时文件。
+void translateLineFile(const std::string& inPath, const std::string& outPath,
+                       const FilePipelineOptions& options, const LineFormat& format,
+                       const TranslateBatch& translate, const ProgressCallback& progress);
+
+// 每个非空行作为一条输入，空行与行尾（\n 或 \r\n）原样保留。
+// 先写入 outPath + ".part"，成功后再重命名为 outPath；失败时抛出异常并删除临时文件。
+void translateTextFile(const std::string& inPath, const std::string& outPath,
+                       const FilePipelineOptions& options, const TranslateBatch& translate,
+                       const ProgressCallback& progress);
+
+// JSONL：每行一条记录，翻译顶层字符串字段 field，译文写入 outputField（为空时覆盖 field）。
+// 不是对象、缺少该字段或字段不是字符串的记录原样输出；不同记录的文本在同一块内一起批量翻译。
+void translateJsonlFile(const std::string& inPath, const std::string& outPath,
+                        const FilePipelineOptions& options, const std::string& field,
+                        const std::string& outputField, const TranslateBatch& translate,
+                        const ProgressCallback& progress);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_FILE_PIPELINE_H
@@ -0,0 +1,25 @@
+#ifndef BERGAMOT_FNV_HASH_H
+#define BERGAMOT_FNV_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bergamot_plugin {
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+// FNV-1a 64 位哈希。seed 可用于把多段数据串联成一个哈希。
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = kFnvOffsetBasis) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_FNV_HASH_H
@@ -0,0 +1,95 @@
+#include "idle_trim.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace bergamot_plugin {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleMonitor {
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t active = 0;
+        Clock::time_point lastActivity = Clock::now();
+        bool trimmed = true;        // 上次回收之后还没有新的请求
+        unsigned idleSeconds = 0;
+        std::function<void()> trim;
+        bool stopping = false;
+        std::thread thread;
+
+        ~IdleMonitor() {
+            stop();
+        }
+
+        void stop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!thread.joinable()) {
+                return;
+            }
+            stopping = true;
+            lock.unlock();
+            changed.notify_all();
+            thread.join();
+            lock.lock();
+            stopping = false;
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                if (active > 0 || trimmed) {
+                    changed.wait(lock);
+                    continue;
+                }
+                Clock::time_point deadline = lastActivity + std::chrono::seconds(idleSeconds);
+                if (Clock::now() < deadline) {
+                    changed.wait_until(lock, deadline);
+                    continue;
+                }
+
+                trimmed = true;
+                std::function<void()> callback = trim;
+                lock.unlock();
+                callback();
+                lock.lock();
+            }
+        }
+    };
+
+    IdleMonitor idle_monitor;
+    std::mutex idle_config_mutex;   // 串行化 setIdleTrim
+}
+
+ActivityScope::ActivityScope() {
+    std::lock_guard<std::mutex> lock(idle_monitor.mutex);
+    ++idle_monitor.active;
+    idle_monitor.trimmed = false;
+}
+
+ActivityScope::~ActivityScope() {
+    {
+        std::lock_guard<std::mutex> lock(idle_monitor.mutex);
+        --idle_monitor.active;
+        idle_monitor.lastActivity = Clock::now();
+    }
+    idle_monitor.changed.notify_all();
+}
+
+void setIdleTrim(unsigned idleSeconds, std::function<void()> trim) {
+    std::lock_guard<std::mutex> config_lock(idle_config_mutex);
+    idle_monitor.stop();
+    if (idleSeconds == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(idle_monitor.mutex);
+    idle_monitor.idleSeconds = idleSeconds;
+    idle_monitor.trim = std::move(trim);
+    idle_monitor.thread = std::thread([] { idle_monitor.run(); });
+}
+
+} // namespace bergamot_plugin
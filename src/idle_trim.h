@@ -0,0 +1,28 @@
+#ifndef BERGAMOT_IDLE_TRIM_H
+#define BERGAMOT_IDLE_TRIM_H
+
+#include <functional>
+
+// 空闲时的内存回收
+//
+// 一阵大批量翻译之后，各工作线程的计算图、工作区及分配器缓存的空闲内存都停留在峰值，
+// 服务随后长时间空闲也不会归还。这里跟踪进行中的请求：持续空闲达到设定时长后，
+// 在后台线程上调用一次回收函数，直到下一次请求结束后才会再次计时。
+namespace bergamot_plugin {
+
+// 请求期间持有，用于判断是否空闲
+class ActivityScope {
+public:
+    ActivityScope();
+    ~ActivityScope();
+
+    ActivityScope(const ActivityScope&) = delete;
+    ActivityScope& operator=(const ActivityScope&) = delete;
+};
+
+// 持续空闲 idleSeconds 秒后调用 trim；idleSeconds 为 0 时关闭并停止后台线程
+void setIdleTrim(unsigned idleSeconds, std::function<void()> trim);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_IDLE_TRIM_H
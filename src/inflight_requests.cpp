@@ -0,0 +1,97 @@
+#include "inflight_requests.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "fnv_hash.h"
+
+namespace bergamot_plugin {
+
+namespace {
+    struct Flight {
+        uint64_t model;
+        std::string text;
+        std::promise<std::string> promise;
+        std::shared_future<std::string> result;
+    };
+
+    std::mutex flight_mutex;
+    // 以 (model, text) 的哈希为键；冲突的条目放在同一个桶里
+    std::unordered_multimap<uint64_t, std::unique_ptr<Flight>> flights;
+    std::atomic<uint64_t> flight_decoded{0};
+    std::atomic<uint64_t> flight_coalesced{0};
+
+    uint64_t flightHash(uint64_t model, const std::string& text) {
+        return fnv1a64(text.data(), text.size(), fnv1a64(&model, sizeof(model)));
+    }
+
+    // 调用者需持有 flight_mutex
+    std::unordered_multimap<uint64_t, std::unique_ptr<Flight>>::iterator
+    findFlight(uint64_t hash, uint64_t model, const std::string& text) {
+        auto range = flights.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->model == model && it->second->text == text) {
+                return it;
+            }
+        }
+        return flights.end();
+    }
+
+    std::unique_ptr<Flight> takeFlight(uint64_t model, const std::string& text) {
+        uint64_t hash = flightHash(model, text);
+        std::lock_guard<std::mutex> lock(flight_mutex);
+        auto it = findFlight(hash, model, text);
+        if (it == flights.end()) {
+            return nullptr;
+        }
+        std::unique_ptr<Flight> flight = std::move(it->second);
+        flights.erase(it);
+        return flight;
+    }
+}
+
+bool joinFlight(uint64_t model, const std::string& text, std::shared_future<std::string>& result) {
+    uint64_t hash = flightHash(model, text);
+    std::lock_guard<std::mutex> lock(flight_mutex);
+    auto it = findFlight(hash, model, text);
+    if (it != flights.end()) {
+        result = it->second->result;
+        flight_coalesced.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::unique_ptr<Flight> flight(new Flight{model, text, std::promise<std::string>(), {}});
+    flight->result = flight->promise.get_future().share();
+    result = flight->result;
+    flights.emplace(hash, std::move(flight));
+    flight_decoded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void completeFlight(uint64_t model, const std::string& text, const std::string& translation) {
+    // 先从表中移除再设置结果，之后到达的请求会查到结果缓存或重新解码
+    std::unique_ptr<Flight> flight = takeFlight(model, text);
+    if (flight != nullptr) {
+        flight->promise.set_value(translation);
+    }
+}
+
+void abandonFlight(uint64_t model, const std::string& text, std::exception_ptr error) {
+    std::unique_ptr<Flight> flight = takeFlight(model, text);
+    if (flight != nullptr) {
+        flight->promise.set_exception(error);
+    }
+}
+
+InflightStats inflightStats() {
+    InflightStats stats;
+    stats.decoded = flight_decoded.load();
+    stats.coalesced = flight_coalesced.load();
+    std::lock_guard<std::mutex> lock(flight_mutex);
+    stats.pending = flights.size();
+    return stats;
+}
+
+} // namespace bergamot_plugin
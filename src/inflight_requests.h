@@ -0,0 +1,33 @@
+#ifndef BERGAMOT_INFLIGHT_REQUESTS_H
+#define BERGAMOT_INFLIGHT_REQUESTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <string>
+
+// 相同请求的合并（singleflight）
+//
+// 结果缓存只在解码完成后才写入，同一时刻到达的相同输入仍会各自解码。这里登记正在解码的
+// (模型内容标识, 输入文本)：第一个请求负责解码，之后到达的相同请求只等待它的结果。
+// 同一批次内的重复输入同样只解码一次。
+namespace bergamot_plugin {
+
+struct InflightStats {
+    uint64_t decoded = 0;     // 实际交给解码器的输入数
+    uint64_t coalesced = 0;   // 合并到已有解码、未重复解码的输入数
+    size_t pending = 0;       // 当前正在解码的不同输入数
+};
+
+// 登记一个输入。返回 true 表示调用方负责解码，之后必须调用 completeFlight 或 abandonFlight；
+// 返回 false 表示已有相同输入在解码，result 会在其完成时就绪（或抛出它的错误）
+bool joinFlight(uint64_t model, const std::string& text, std::shared_future<std::string>& result);
+void completeFlight(uint64_t model, const std::string& text, const std::string& translation);
+void abandonFlight(uint64_t model, const std::string& text, std::exception_ptr error);
+
+InflightStats inflightStats();
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_INFLIGHT_REQUESTS_H
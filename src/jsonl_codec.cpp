@@ -0,0 +1,251 @@
+#include "jsonl_codec.h"
+
+#include <cstdio>
+#include <cstdint>
+
+namespace bergamot_plugin {
+
+namespace {
+    void skipSpace(const std::string& s, size_t& pos) {
+        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\r' || s[pos] == '\n')) {
+            ++pos;
+        }
+    }
+
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool readHex4(const std::string& s, size_t pos, uint32_t& value) {
+        if (pos + 4 > s.size()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            int digit = hexDigit(s[pos + i]);
+            if (digit < 0) {
+                return false;
+            }
+            value = (value << 4) | (uint32_t)digit;
+        }
+        return true;
+    }
+
+    void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // pos 指向开头的引号；成功时 pos 指向结尾引号之后，decoded 为解码后的文本（可为 nullptr 只做跳过）
+    bool parseString(const std::string& s, size_t& pos, std::string* decoded) {
+        if (pos >= s.size() || s[pos] != '"') {
+            return false;
+        }
+        ++pos;
+        while (pos < s.size()) {
+            char c = s[pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                if (decoded) *decoded += c;
+                continue;
+            }
+            if (pos >= s.size()) {
+                return false;
+            }
+            char e = s[pos++];
+            uint32_t cp = 0;
+            switch (e) {
+                case '"': case '\\': case '/': cp = (uint32_t)e; break;
+                case 'b': cp = '\b'; break;
+                case 'f': cp = '\f'; break;
+                case 'n': cp = '\n'; break;
+                case 'r': cp = '\r'; break;
+                case 't': cp = '\t'; break;
+                case 'u': {
+                    if (!readHex4(s, pos, cp)) {
+                        return false;
+                    }
+                    pos += 4;
+                    // 代理对
+                    uint32_t low;
+                    if (cp >= 0xD800 && cp <= 0xDBFF && pos + 6 <= s.size() && s[pos] == '\\' && s[pos + 1] == 'u' &&
+                        readHex4(s, pos + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        pos += 6;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+            if (decoded) appendUtf8(*decoded, cp);
+        }
+        return false;
+    }
+
+    // 跳过任意 JSON 值（对象、数组、字符串、字面量），不做完整校验
+    bool skipValue(const std::string& s, size_t& pos) {
+        skipSpace(s, pos);
+        if (pos >= s.size()) {
+            return false;
+        }
+        if (s[pos] == '"') {
+            return parseString(s, pos, nullptr);
+        }
+        if (s[pos] == '{' || s[pos] == '[') {
+            int depth = 0;
+            while (pos < s.size()) {
+                char c = s[pos];
+                if (c == '"') {
+                    if (!parseString(s, pos, nullptr)) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        ++pos;
+                        return true;
+                    }
+                }
+                ++pos;
+            }
+            return false;
+        }
+        while (pos < s.size() && s[pos] != ',' && s[pos] != '}' && s[pos] != ']') {
+            ++pos;
+        }
+        return true;
+    }
+
+    // 扫描顶层对象；找到 key 时记录值的区间。closePos 为结尾 '}' 的位置，empty 表示对象没有任何键
+    bool scanObject(const std::string& s, const std::string& key, size_t& valueBegin, size_t& valueEnd,
+                    bool& found, size_t& closePos, bool& empty) {
+        found = false;
+        empty = true;
+        size_t pos = 0;
+        skipSpace(s, pos);
+        if (pos >= s.size() || s[pos] != '{') {
+            return false;
+        }
+        ++pos;
+        while (true) {
+            skipSpace(s, pos);
+            if (pos >= s.size()) {
+                return false;
+            }
+            if (s[pos] == '}') {
+                closePos = pos;
+                return true;
+            }
+            if (s[pos] == ',') {
+                ++pos;
+                continue;
+            }
+
+            std::string name;
+            if (!parseString(s, pos, &name)) {
+                return false;
+            }
+            empty = false;
+            skipSpace(s, pos);
+            if (pos >= s.size() || s[pos] != ':') {
+                return false;
+            }
+            ++pos;
+            skipSpace(s, pos);
+            size_t begin = pos;
+            if (!skipValue(s, pos)) {
+                return false;
+            }
+            if (!found && name == key) {
+                found = true;
+                valueBegin = begin;
+                valueEnd = pos;
+            }
+        }
+    }
+}
+
+bool findJsonStringField(const std::string& record, const std::string& key, JsonStringField& field) {
+    size_t begin = 0, end = 0, closePos = 0;
+    bool found = false, empty = true;
+    if (!scanObject(record, key, begin, end, found, closePos, empty) || !found || record[begin] != '"') {
+        return false;
+    }
+
+    size_t pos = begin;
+    std::string value;
+    if (!parseString(record, pos, &value)) {
+        return false;
+    }
+    field.begin = begin;
+    field.end = pos;
+    field.value = std::move(value);
+    return true;
+}
+
+std::string encodeJsonString(const std::string& value) {
+    std::string out;
+    out.reserve(value.size() + 2);
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    return out;
+}
+
+bool setJsonStringField(std::string& record, const std::string& key, const std::string& value) {
+    size_t begin = 0, end = 0, closePos = 0;
+    bool found = false, empty = true;
+    if (!scanObject(record, key, begin, end, found, closePos, empty)) {
+        return false;
+    }
+
+    if (found) {
+        record.replace(begin, end - begin, encodeJsonString(value));
+    } else {
+        std::string member = (empty ? "" : ",") + encodeJsonString(key) + ":" + encodeJsonString(value);
+        record.insert(closePos, member);
+    }
+    return true;
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,31 @@
+#ifndef BERGAMOT_JSONL_CODEC_H
+#define BERGAMOT_JSONL_CODEC_H
+
+#include <cstddef>
+#include <string>
+
+// JSONL 记录中单个字符串字段的读取与回写
+//
+// 只扫描记录的顶层键，不构建完整的 JSON 树：字段值按字节区间定位，
+// 回写时只替换该区间，其余内容（键顺序、空白、数字格式）原样保留。
+namespace bergamot_plugin {
+
+struct JsonStringField {
+    size_t begin = 0;   // 值（含引号）在记录中的字节区间
+    size_t end = 0;
+    std::string value;  // 已解码的 UTF-8 文本
+};
+
+// 在顶层对象中查找字符串类型的字段；记录不是对象、字段不存在或不是字符串时返回 false
+bool findJsonStringField(const std::string& record, const std::string& key, JsonStringField& field);
+
+// 编码为 JSON 字符串字面量（含引号）
+std::string encodeJsonString(const std::string& value);
+
+// 把 key 的值设为 value：字段存在时原位替换，否则追加到对象末尾
+// 记录不是对象时返回 false
+bool setJsonStringField(std::string& record, const std::string& key, const std::string& value);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_JSONL_CODEC_H
@@ -0,0 +1,418 @@
+#include "model_bundle.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#if !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "3rd_party/yaml-cpp/yaml.h"
+#include "translator/byte_array_util.h"
+#include "translator/parser.h"
+
+#include "fnv_hash.h"
+
+using namespace marian::bergamot;
+
+namespace bergamot_plugin {
+
+namespace {
+    // 配置项记录类型
+    enum OptionKind : uint8_t {
+        kOptionBool = 1,
+        kOptionInt = 2,
+        kOptionFloat = 3,
+        kOptionString = 4,
+        kOptionStringList = 5,
+    };
+
+    size_t alignUp(size_t value) {
+        return (value + kBundleAlignment - 1) / kBundleAlignment * kBundleAlignment;
+    }
+
+    template <typename T>
+    void appendPod(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void appendString(std::string& out, const std::string& value) {
+        appendPod<uint32_t>(out, (uint32_t)value.size());
+        out.append(value);
+    }
+
+    void appendScalar(std::string& out, const std::string& key, const std::string& scalar) {
+        char* end = nullptr;
+
+        if (scalar == "true" || scalar == "false") {
+            appendPod<uint8_t>(out, kOptionBool);
+            appendString(out, key);
+            appendPod<uint8_t>(out, scalar == "true" ? 1 : 0);
+            return;
+        }
+
+        errno = 0;
+        long long asInt = std::strtoll(scalar.c_str(), &end, 10);
+        if (!scalar.empty() && errno == 0 && *end == '\0') {
+            appendPod<uint8_t>(out, kOptionInt);
+            appendString(out, key);
+            appendPod<int64_t>(out, (int64_t)asInt);
+            return;
+        }
+
+        errno = 0;
+        double asFloat = std::strtod(scalar.c_str(), &end);
+        if (!scalar.empty() && errno == 0 && *end == '\0') {
+            appendPod<uint8_t>(out, kOptionFloat);
+            appendString(out, key);
+            appendPod<double>(out, asFloat);
+            return;
+        }
+
+        appendPod<uint8_t>(out, kOptionString);
+        appendString(out, key);
+        appendString(out, scalar);
+    }
+
+    // 把用户配置中出现的顶层键编码为带类型的记录，加载时直接 set 到 Options 上
+    std::string encodeOptions(const YAML::Node& config) {
+        std::string records;
+        uint32_t count = 0;
+
+        for (auto it = config.begin(); it != config.end(); ++it) {
+            const std::string key = it->first.as<std::string>();
+            const YAML::Node& value = it->second;
+
+            // 模型在打包时已校验过，加载时无需再次校验
+            if (key == "check-bytearray") {
+                continue;
+            }
+
+            if (value.IsSequence()) {
+                appendPod<uint8_t>(records, kOptionStringList);
+                appendString(records, key);
+                appendPod<uint32_t>(records, (uint32_t)value.size());
+                for (size_t i = 0; i < value.size(); ++i) {
+                    appendString(records, value[i].as<std::string>());
+                }
+            } else if (value.IsScalar()) {
+                appendScalar(records, key, value.Scalar());
+            } else {
+                throw std::runtime_error("Unsupported config value for key: " + key);
+            }
+            ++count;
+        }
+
+        appendPod<uint8_t>(records, kOptionBool);
+        appendString(records, "check-bytearray");
+        appendPod<uint8_t>(records, 0);
+        ++count;
+
+        std::string out;
+        appendPod<uint32_t>(out, count);
+        out.append(records);
+        return out;
+    }
+
+    // 配置记录的顺序读取器，越界时抛出异常
+    class RecordReader {
+    public:
+        RecordReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+        template <typename T>
+        T pod() {
+            need(sizeof(T));
+            T value;
+            std::memcpy(&value, data_ + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return value;
+        }
+
+        std::string string() {
+            uint32_t len = pod<uint32_t>();
+            need(len);
+            std::string value(data_ + pos_, len);
+            pos_ += len;
+            return value;
+        }
+
+    private:
+        void need(size_t bytes) {
+            if (pos_ + bytes > size_) {
+                throw std::runtime_error("Truncated options section in model bundle");
+            }
+        }
+
+        const char* data_;
+        size_t size_;
+        size_t pos_ = 0;
+    };
+
+    struct PendingSection {
+        BundleSectionType type;
+        const char* data;
+        size_t size;
+    };
+}
+
+void writeModelBundle(const std::string& configYaml, const std::string& outPath) {
+    YAML::Node config = YAML::Load(configYaml);
+    if (!config.IsMap()) {
+        throw std::runtime_error("Model config must be a YAML map");
+    }
+
+    auto options = parseOptionsFromString(configYaml, /*validate=*/false, "");
+
+    AlignedMemory model = getModelMemoryFromConfig(options);
+    if (!validateBinaryModel(model, model.size())) {
+        throw std::runtime_error("Model file is invalid. Incomplete or corrupted download?");
+    }
+    AlignedMemory shortlist = getShortlistMemoryFromConfig(options);
+    std::vector<std::shared_ptr<AlignedMemory>> vocabs;
+    getVocabsMemoryFromConfig(options, vocabs);
+    AlignedMemory ssplitPrefix = getSsplitPrefixFileMemoryFromConfig(options);
+    AlignedMemory qualityEstimator = getQualityEstimatorModel(options);
+    std::string encodedOptions = encodeOptions(config);
+
+    std::vector<PendingSection> pending;
+    pending.push_back({BundleSectionType::Options, encodedOptions.data(), encodedOptions.size()});
+    pending.push_back({BundleSectionType::Model, model.begin(), model.size()});
+    if (shortlist.size() > 0) {
+        pending.push_back({BundleSectionType::Shortlist, shortlist.begin(), shortlist.size()});
+    }
+    for (const auto& vocab : vocabs) {
+        pending.push_back({BundleSectionType::Vocab, vocab->begin(), vocab->size()});
+    }
+    if (ssplitPrefix.size() > 0) {
+        pending.push_back({BundleSectionType::SsplitPrefix, ssplitPrefix.begin(), ssplitPrefix.size()});
+    }
+    if (qualityEstimator.size() > 0) {
+        pending.push_back({BundleSectionType::QualityEstimator, qualityEstimator.begin(), qualityEstimator.size()});
+    }
+
+    // 计算布局；源词表与目标词表相同（joint vocab）时两个段指向同一份数据
+    std::vector<BundleSection> sections;
+    std::unordered_map<const char*, size_t> written;
+    size_t offset = alignUp(sizeof(BundleHeader) + pending.size() * sizeof(BundleSection));
+    for (const auto& p : pending) {
+        BundleSection section{};
+        section.type = (uint32_t)p.type;
+        section.size = p.size;
+        auto it = written.find(p.data);
+        if (it != written.end()) {
+            section.offset = sections[it->second].offset;
+            section.checksum = sections[it->second].checksum;
+        } else {
+            section.offset = offset;
+            section.checksum = fnv1a64(p.data, p.size);
+            written[p.data] = sections.size();
+            offset = alignUp(offset + p.size);
+        }
+        sections.push_back(section);
+    }
+
+    BundleHeader header{};
+    std::memcpy(header.magic, kBundleMagic, sizeof(kBundleMagic));
+    header.version = kBundleVersion;
+    header.sectionCount = (uint32_t)sections.size();
+    header.fileSize = offset;
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open output file: " + outPath);
+    }
+
+    static const char zeros[kBundleAlignment] = {0};
+    size_t pos = 0;
+    auto writeBytes = [&](const char* data, size_t size) {
+        out.write(data, (std::streamsize)size);
+        pos += size;
+    };
+    auto padTo = [&](size_t target) {
+        while (pos < target) {
+            size_t n = std::min(target - pos, sizeof(zeros));
+            writeBytes(zeros, n);
+        }
+    };
+
+    writeBytes(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeBytes(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(BundleSection));
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (sections[i].offset < pos) {
+            continue; // 共享数据，已写出
+        }
+        padTo(sections[i].offset);
+        writeBytes(pending[i].data, pending[i].size);
+    }
+    padTo(offset);
+
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write model bundle: " + outPath);
+    }
+}
+
+ModelBundle::ModelBundle(const std::string& path) {
+#if _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open model bundle: " + path);
+    }
+    buffer_.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(buffer_.data(), (std::streamsize)buffer_.size());
+    if (!in) {
+        throw std::runtime_error("Failed to read model bundle: " + path);
+    }
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open model bundle: " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat model bundle: " + path);
+    }
+    void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot mmap model bundle: " + path + ": " + std::strerror(errno));
+    }
+#ifdef MADV_WILLNEED
+    // 段会被顺序拷贝一遍，提前让内核预读
+    madvise(mapped, (size_t)st.st_size, MADV_WILLNEED);
+#endif
+    data_ = static_cast<const char*>(mapped);
+    size_ = (size_t)st.st_size;
+#endif
+
+    try {
+        if (size_ < sizeof(BundleHeader)) {
+            throw std::runtime_error("File too small");
+        }
+        BundleHeader header;
+        std::memcpy(&header, data_, sizeof(header));
+        if (std::memcmp(header.magic, kBundleMagic, sizeof(kBundleMagic)) != 0) {
+            throw std::runtime_error("Bad magic");
+        }
+        if (header.version != kBundleVersion) {
+            throw std::runtime_error("Unsupported version " + std::to_string(header.version));
+        }
+        if (header.fileSize != size_) {
+            throw std::runtime_error("Size mismatch, incomplete download?");
+        }
+        size_t tableEnd = sizeof(BundleHeader) + (size_t)header.sectionCount * sizeof(BundleSection);
+        if (tableEnd > size_) {
+            throw std::runtime_error("Truncated section table");
+        }
+
+        sections_.resize(header.sectionCount);
+        std::memcpy(sections_.data(), data_ + sizeof(BundleHeader), header.sectionCount * sizeof(BundleSection));
+        for (const auto& section : sections_) {
+            if (section.offset % kBundleAlignment != 0 || section.offset < tableEnd ||
+                section.size > size_ || section.offset > size_ - section.size) {
+                throw std::runtime_error("Corrupted section table");
+            }
+        }
+    } catch (const std::exception& e) {
+        release();
+        throw std::runtime_error("Invalid model bundle " + path + ": " + e.what());
+    }
+}
+
+ModelBundle::~ModelBundle() {
+    release();
+}
+
+void ModelBundle::release() {
+#if !_WIN32
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+AlignedMemory ModelBundle::copySection(const BundleSection& section) const {
+    AlignedMemory memory(section.size, kBundleAlignment);
+    std::memcpy(memory.begin(), data_ + section.offset, section.size);
+    dropPages((size_t)section.offset, (size_t)section.size);
+    return memory;
+}
+
+void ModelBundle::dropPages(size_t offset, size_t size) const {
+#if !_WIN32 && defined(MADV_DONTNEED)
+    // 只读的私有映射从未写入，丢弃后再访问会从文件重新读入，因此向外取整到页边界也是安全的
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset / page * page;
+    size_t end = std::min(size_, (offset + size + page - 1) / page * page);
+    if (end > begin) {
+        madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)size;
+#endif
+}
+
+std::shared_ptr<marian::Options> ModelBundle::options(const marian::Options& defaults) const {
+    const BundleSection* optionsSection = nullptr;
+    for (const auto& section : sections_) {
+        if (section.type == (uint32_t)BundleSectionType::Options) {
+            optionsSection = &section;
+            break;
+        }
+    }
+    if (optionsSection == nullptr) {
+        throw std::runtime_error("Model bundle has no options section");
+    }
+
+    auto options = std::make_shared<marian::Options>(defaults.clone());
+    RecordReader reader(data_ + optionsSection->offset, optionsSection->size);
+    uint32_t count = reader.pod<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i) {
+        uint8_t kind = reader.pod<uint8_t>();
+        std::string key = reader.string();
+        switch (kind) {
+            case kOptionBool:
+                options->set<bool>(key, reader.pod<uint8_t>() != 0);
+                break;
+            case kOptionInt:
+                options->set<int64_t>(key, reader.pod<int64_t>());
+                break;
+            case kOptionFloat:
+                options->set<double>(key, reader.pod<double>());
+                break;
+            case kOptionString:
+                options->set<std::string>(key, reader.string());
+                break;
+            case kOptionStringList: {
+                uint32_t n = reader.pod<uint32_t>();
+                std::vector<std::string> values;
+                values.reserve(n);
+                for (uint32_t j = 0; j < n; ++j) {
+                    values.push_back(reader.string());
+                }
+                options->set<std::vector<std::string>>(key, values);
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown option kind in model bundle");
+        }
+    }
+    return options;
+}
+
+} // namespace bergamot_plugin
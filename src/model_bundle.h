@@ -0,0 +1,96 @@
+#ifndef BERGAMOT_MODEL_BUNDLE_H
+#define BERGAMOT_MODEL_BUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "translator/definitions.h"
+
+// 单文件模型包（.bgtb）
+//
+// 把一个语言对需要的全部内容打包进一个按 256 字节对齐的文件：
+// 权重（model.intgemm.alphas.bin 原样存放）、词表、shortlist、ssplit 前缀文件、
+// QE 模型，以及预先解析好的配置项。加载时映射整个文件，不再逐个打开文件，
+// 也不再解析/校验 YAML 配置。bergamot 的 MemoryBundle 要求自有内存，各段仍需从映射区
+// 拷出一份；每段拷完即释放其映射页，峰值约为模型大小加最大一段，而不是两倍。
+//
+// 文件布局：
+//   BundleHeader（64 字节）
+//   BundleSection[sectionCount]
+//   各段数据，每段起始偏移按 kBundleAlignment 对齐
+//
+// 所有整数按本机字节序写入（所有受支持平台都是小端）。
+namespace bergamot_plugin {
+
+constexpr char kBundleMagic[8] = {'B', 'G', 'T', 'B', 'N', 'D', 'L', '\0'};
+constexpr uint32_t kBundleVersion = 1;
+constexpr size_t kBundleAlignment = 256;
+
+enum class BundleSectionType : uint32_t {
+    Options = 1,
+    Model = 2,
+    Shortlist = 3,
+    Vocab = 4,
+    SsplitPrefix = 5,
+    QualityEstimator = 6,
+};
+
+struct BundleHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(BundleHeader) == 64, "BundleHeader must stay 64 bytes");
+
+struct BundleSection {
+    uint32_t type;      // BundleSectionType
+    uint32_t reserved;
+    uint64_t offset;    // 相对文件起始位置
+    uint64_t size;
+    uint64_t checksum;  // 段内容的 FNV-1a 64，用于词表去重
+};
+static_assert(sizeof(BundleSection) == 32, "BundleSection must stay 32 bytes");
+
+// 根据 YAML 配置（与 bergamot_load_model 接收的格式相同）生成模型包。
+// 失败时抛出 std::runtime_error。
+void writeModelBundle(const std::string& configYaml, const std::string& outPath);
+
+// 只读映射的模型包
+class ModelBundle {
+public:
+    // 打开并校验模型包，失败时抛出 std::runtime_error
+    explicit ModelBundle(const std::string& path);
+    ~ModelBundle();
+
+    ModelBundle(const ModelBundle&) = delete;
+    ModelBundle& operator=(const ModelBundle&) = delete;
+
+    const std::vector<BundleSection>& sections() const { return sections_; }
+
+    // bergamot 的 MemoryBundle 需要自有的对齐内存，这里从映射区拷贝一份，
+    // 随后丢弃该段的映射页（再次访问时从文件重新读入）
+    marian::bergamot::AlignedMemory copySection(const BundleSection& section) const;
+
+    // 以 defaults 为基础，应用包内预解析的配置项
+    std::shared_ptr<marian::Options> options(const marian::Options& defaults) const;
+
+private:
+    void release();
+    void dropPages(size_t offset, size_t size) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<BundleSection> sections_;
+#if _WIN32
+    std::vector<char> buffer_;
+#endif
+};
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_MODEL_BUNDLE_H
@@ -0,0 +1,186 @@
+#include "passthrough_filter.h"
+
+#include <cstring>
+
+namespace bergamot_plugin {
+
+namespace {
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool isLetter(char c) {
+        // 非 ASCII 字节一律视为文字，宁可翻译也不误判为可跳过
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (unsigned char)c >= 0x80;
+    }
+
+    bool isHexLetter(char c) {
+        return (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    // 片段末尾的标点属于句子而不属于 URL、邮箱
+    size_t trimTrailingPunctuation(const std::string& s, size_t begin, size_t end) {
+        while (end > begin && std::strchr(".,;:!?)]}\"'", s[end - 1]) != nullptr) {
+            --end;
+        }
+        return end;
+    }
+
+    bool startsWith(const std::string& s, size_t pos, const char* prefix) {
+        size_t length = std::strlen(prefix);
+        if (pos + length > s.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            char c = s[pos + i];
+            if (c >= 'A' && c <= 'Z') {
+                c = (char)(c - 'A' + 'a');
+            }
+            if (c != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isUrl(const std::string& s, size_t begin, size_t end) {
+        if (startsWith(s, begin, "www.")) {
+            return end - begin > 4;
+        }
+        // scheme://...
+        size_t pos = begin;
+        while (pos < end && ((s[pos] >= 'a' && s[pos] <= 'z') || (s[pos] >= 'A' && s[pos] <= 'Z'))) {
+            ++pos;
+        }
+        return pos > begin && pos + 3 < end && s.compare(pos, 3, "://") == 0;
+    }
+
+    bool isEmail(const std::string& s, size_t begin, size_t end) {
+        size_t at = s.find('@', begin);
+        if (at == std::string::npos || at == begin || at >= end) {
+            return false;
+        }
+        size_t dot = s.find('.', at);
+        return dot != std::string::npos && dot > at + 1 && dot + 1 < end;
+    }
+
+    // git 提交号、UUID、摘要值：十六进制字符（可含连字符），同时包含数字与字母
+    bool isHash(const std::string& s, size_t begin, size_t end) {
+        if (end - begin < 7) {
+            return false;
+        }
+        bool digit = false, hexLetter = false;
+        for (size_t i = begin; i < end; ++i) {
+            char c = s[i];
+            if (isDigit(c)) {
+                digit = true;
+            } else if (isHexLetter(c)) {
+                hexLetter = true;
+            } else if (c != '-') {
+                return false;
+            }
+        }
+        return digit && hexLetter;
+    }
+
+    // 不含字母：数字、日期、金额、版本号、纯符号
+    bool hasNoLetters(const std::string& s, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (isLetter(s[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 不按括号、分号、下划线等符号判定代码："(Optional)"、"[Beta]"、"Hello;"、"user_name" 都是要翻译的文字
+    bool isVerbatimToken(const std::string& s, size_t begin, size_t end) {
+        size_t trimmed = trimTrailingPunctuation(s, begin, end);
+        return hasNoLetters(s, begin, end) || isUrl(s, begin, trimmed) || isEmail(s, begin, trimmed) ||
+               isHash(s, begin, trimmed);
+    }
+
+    std::string placeholder(size_t index) {
+        return "__" + std::to_string(index) + "__";
+    }
+}
+
+bool isVerbatimText(const std::string& text) {
+    size_t pos = 0;
+    bool any = false;
+    while (pos < text.size()) {
+        while (pos < text.size() && isBlank(text[pos])) {
+            ++pos;
+        }
+        if (pos == text.size()) {
+            break;
+        }
+        size_t begin = pos;
+        while (pos < text.size() && !isBlank(text[pos])) {
+            ++pos;
+        }
+        if (!isVerbatimToken(text, begin, pos)) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
+
+MaskedText maskVerbatimSpans(const std::string& text) {
+    MaskedText masked;
+    size_t pos = 0;
+    size_t copied = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && isBlank(text[pos])) {
+            ++pos;
+        }
+        size_t begin = pos;
+        while (pos < text.size() && !isBlank(text[pos])) {
+            ++pos;
+        }
+        if (begin == pos) {
+            break;
+        }
+
+        // 只替换这几类：数字与代码片段留给模型处理，它们通常会原样复制或本身需要翻译上下文
+        size_t end = trimTrailingPunctuation(text, begin, pos);
+        if (end > begin && (isUrl(text, begin, end) || isEmail(text, begin, end) || isHash(text, begin, end))) {
+            masked.text.append(text, copied, begin - copied);
+            masked.text += placeholder(masked.spans.size());
+            masked.spans.push_back(text.substr(begin, end - begin));
+            copied = end;
+        }
+    }
+    if (masked.spans.empty()) {
+        masked.text = text;
+    } else {
+        masked.text.append(text, copied, std::string::npos);
+    }
+    return masked;
+}
+
+bool restoreVerbatimSpans(const MaskedText& masked, const std::string& translation, std::string& restored) {
+    if (masked.spans.empty()) {
+        restored = translation;
+        return true;
+    }
+
+    restored = translation;
+    // 倒序替换，避免 __1__ 命中 __11__ 的一部分
+    for (size_t i = masked.spans.size(); i-- > 0;) {
+        std::string token = placeholder(i);
+        size_t found = restored.find(token);
+        if (found == std::string::npos || restored.find(token, found + token.size()) != std::string::npos) {
+            return false;
+        }
+        restored.replace(found, token.size(), masked.spans[i]);
+    }
+    return true;
+}
+
+} // namespace bergamot_plugin
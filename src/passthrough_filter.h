@@ -0,0 +1,30 @@
+#ifndef BERGAMOT_PASSTHROUGH_FILTER_H
+#define BERGAMOT_PASSTHROUGH_FILTER_H
+
+#include <string>
+#include <vector>
+
+// 不需翻译内容的旁路
+//
+// 纯数字、URL、邮箱、哈希之类的输入送进解码器既浪费算力，又常被改写。
+// 整段都是这类内容时直接原样返回；句子中夹带的 URL、邮箱、哈希可先替换为占位符再翻译，
+// 译文中占位符完整保留时再换回原文，否则改为翻译未替换的原文。
+namespace bergamot_plugin {
+
+// 整段均为数字、URL、邮箱、哈希或符号，没有需要翻译的词
+bool isVerbatimText(const std::string& text);
+
+struct MaskedText {
+    std::string text;                  // 替换后的文本
+    std::vector<std::string> spans;    // 按占位符编号保存的原文片段
+};
+
+// 把 URL、邮箱、哈希替换为占位符；没有可替换的片段时 spans 为空、text 与原文相同
+MaskedText maskVerbatimSpans(const std::string& text);
+
+// 把译文中的占位符换回原文片段；任一占位符缺失或重复时返回 false
+bool restoreVerbatimSpans(const MaskedText& masked, const std::string& translation, std::string& restored);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_PASSTHROUGH_FILTER_H
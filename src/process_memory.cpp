@@ -0,0 +1,65 @@
+#include "process_memory.h"
+
+#if defined(__linux__)
+#include <cstdio>
+#include <cstring>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#endif
+
+namespace bergamot_plugin {
+
+ProcessMemory processMemory() {
+    ProcessMemory memory;
+#if defined(__linux__)
+    // /proc/self/status 中的 VmRSS（当前）与 VmHWM（峰值），单位 kB
+    FILE* status = std::fopen("/proc/self/status", "r");
+    if (status == nullptr) {
+        return memory;
+    }
+    char line[256];
+    while (std::fgets(line, sizeof(line), status) != nullptr) {
+        long long kb;
+        if (std::strncmp(line, "VmRSS:", 6) == 0 && std::sscanf(line + 6, "%lld", &kb) == 1) {
+            memory.resident = (int64_t)kb * 1024;
+        } else if (std::strncmp(line, "VmHWM:", 6) == 0 && std::sscanf(line + 6, "%lld", &kb) == 1) {
+            memory.peakResident = (int64_t)kb * 1024;
+        }
+    }
+    std::fclose(status);
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        memory.resident = (int64_t)info.resident_size;
+        memory.peakResident = (int64_t)info.resident_size_max;
+    }
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        memory.resident = (int64_t)counters.WorkingSetSize;
+        memory.peakResident = (int64_t)counters.PeakWorkingSetSize;
+    }
+#endif
+    return memory;
+}
+
+void releaseFreeHeap() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#elif defined(__ANDROID__) && defined(M_PURGE)
+    mallopt(M_PURGE, 0);
+#elif defined(__APPLE__)
+    malloc_zone_pressure_relief(nullptr, 0);
+#elif defined(_WIN32)
+    _heapmin();
+#endif
+}
+
+} // namespace bergamot_plugin
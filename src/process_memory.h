@@ -0,0 +1,26 @@
+#ifndef BERGAMOT_PROCESS_MEMORY_H
+#define BERGAMOT_PROCESS_MEMORY_H
+
+#include <cstdint>
+
+// 进程级内存统计与回收
+//
+// 库内部能按模型、按组件统计自己交给 bergamot 的内存，但 marian 的运行时分配、
+// 分配器的碎片与其他库的占用只能从操作系统看到。这里读取进程常驻内存（RSS）及其峰值，
+// 并在需要时让分配器把空闲页还给操作系统。
+namespace bergamot_plugin {
+
+struct ProcessMemory {
+    int64_t resident = -1;      // 当前常驻内存字节数，-1 表示不可用
+    int64_t peakResident = -1;  // 常驻内存峰值
+};
+
+ProcessMemory processMemory();
+
+// 让 malloc 把缓存的空闲内存还给操作系统（glibc malloc_trim、Android M_PURGE、
+// macOS/iOS malloc_zone_pressure_relief、Windows _heapmin），不支持的平台上什么也不做
+void releaseFreeHeap();
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_PROCESS_MEMORY_H
@@ -0,0 +1,140 @@
+#include "repetition_guard.h"
+
+#include <cstring>
+#include <vector>
+
+namespace bergamot_plugin {
+
+namespace {
+    constexpr size_t kMaxPhraseWords = 3;
+
+    struct Word {
+        size_t spaceBegin;  // 前导空白起点
+        size_t begin;
+        size_t end;
+    };
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    std::vector<Word> splitWords(const std::string& text) {
+        std::vector<Word> words;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t spaceBegin = pos;
+            while (pos < text.size() && isSpace(text[pos])) {
+                ++pos;
+            }
+            if (pos == text.size()) {
+                break;
+            }
+            size_t begin = pos;
+            while (pos < text.size() && !isSpace(text[pos])) {
+                ++pos;
+            }
+            words.push_back(Word{spaceBegin, begin, pos});
+        }
+        return words;
+    }
+
+    bool isLetter(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    // 纯数字、标点或符号的词（编号、分隔线）不参与折叠
+    bool hasLetter(const std::string& text, const Word& word) {
+        for (size_t i = word.begin; i < word.end; ++i) {
+            unsigned char c = (unsigned char)text[i];
+            if (isLetter(c) || c >= 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool sameWord(const std::string& text, const Word& a, const Word& b) {
+        size_t length = a.end - a.begin;
+        return length == b.end - b.begin && std::memcmp(text.data() + a.begin, text.data() + b.begin, length) == 0;
+    }
+
+    // 从 start 开始、长度为 n 的词组连续出现的次数
+    size_t countRepeats(const std::string& text, const std::vector<Word>& words, size_t start, size_t n) {
+        for (size_t k = 0; k < n; ++k) {
+            if (!hasLetter(text, words[start + k])) {
+                return 1;
+            }
+        }
+        size_t repeats = 1;
+        while (start + (repeats + 1) * n <= words.size()) {
+            size_t next = start + repeats * n;
+            for (size_t k = 0; k < n; ++k) {
+                if (!sameWord(text, words[start + k], words[next + k])) {
+                    return repeats;
+                }
+            }
+            ++repeats;
+        }
+        return repeats;
+    }
+
+    std::string collapseLetterRuns(const std::string& text, size_t maxRun) {
+        std::string out;
+        out.reserve(text.size());
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = (unsigned char)text[i];
+            // 只处理 ASCII 字母：不截断多字节 UTF-8 字符，也不改动数字与标点
+            run = (i > 0 && isLetter(c) && text[i - 1] == text[i]) ? run + 1 : 1;
+            if (run <= maxRun) {
+                out += (char)c;
+            }
+        }
+        return out;
+    }
+}
+
+std::string collapseRepeats(const std::string& text, size_t maxRepeats, bool collapseLetters) {
+    if (maxRepeats == 0) {
+        return text;
+    }
+
+    std::string input = collapseLetters ? collapseLetterRuns(text, 4 * maxRepeats) : text;
+    std::vector<Word> words = splitWords(input);
+    std::vector<bool> keep(words.size(), true);
+    bool changed = input.size() != text.size();
+
+    size_t i = 0;
+    while (i < words.size()) {
+        size_t skip = 1;
+        for (size_t n = 1; n <= kMaxPhraseWords && i + n <= words.size(); ++n) {
+            size_t repeats = countRepeats(input, words, i, n);
+            if (repeats > maxRepeats) {
+                for (size_t k = i + maxRepeats * n; k < i + repeats * n; ++k) {
+                    keep[k] = false;
+                }
+                skip = repeats * n;
+                changed = true;
+                break;
+            }
+        }
+        i += skip;
+    }
+    if (!changed) {
+        return text;
+    }
+
+    std::string out;
+    out.reserve(input.size());
+    for (size_t k = 0; k < words.size(); ++k) {
+        if (keep[k]) {
+            out.append(input, words[k].spaceBegin, words[k].end - words[k].spaceBegin);
+        }
+    }
+    // 保留结尾空白
+    size_t tail = words.empty() ? 0 : words.back().end;
+    out.append(input, tail, std::string::npos);
+    return out;
+}
+
+} // namespace bergamot_plugin
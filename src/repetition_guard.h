@@ -0,0 +1,22 @@
+#ifndef BERGAMOT_REPETITION_GUARD_H
+#define BERGAMOT_REPETITION_GUARD_H
+
+#include <cstddef>
+#include <string>
+
+// 退化输入与输出的重复折叠
+//
+// 大量重复的词组（"ha ha ha ..."）在子词编码后变得很长，解码器通常会跟着重复到 max-length 上限，
+// 整个批次都要等它结束。进入 bergamot 之前把超过上限的连续重复词组折叠掉，解码步数随之下降；
+// 译文还会折叠同一字母的长串，去掉解码器自身的重复循环。
+// 数字、标点与符号（长编号、"----" 分隔线、"____" 填空）不视为重复，原样保留。
+namespace bergamot_plugin {
+
+// 以空白分词，连续重复超过 maxRepeats 次的 1~3 词片段只保留 maxRepeats 次（片段中每个词都须含字母，
+// 非 ASCII 字符视为字母）；collapseLetters 为 true 时，同一 ASCII 字母连续超过 4 * maxRepeats 个
+// 也截断到该长度。maxRepeats 为 0 时原样返回
+std::string collapseRepeats(const std::string& text, size_t maxRepeats, bool collapseLetters);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_REPETITION_GUARD_H
@@ -0,0 +1,195 @@
+#include "request_trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace bergamot_plugin {
+
+namespace {
+    // sequence：0 未写入；写入中为奇数；写完为 2 * (ticket + 1)
+    // 读取方前后两次读到相同的偶数才采用该记录（seqlock），写入方从不等待
+    struct TraceSlot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> request{0};
+        std::atomic<int64_t> begin{0};
+        std::atomic<int64_t> end{0};
+        std::atomic<int64_t> count{0};
+        std::atomic<uint32_t> thread{0};
+    };
+
+    struct TraceBuffer {
+        explicit TraceBuffer(size_t capacity) : slots(capacity) {}
+
+        std::vector<TraceSlot> slots;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> floor{0};    // 早于该序号的记录视为已清空
+    };
+
+    std::atomic<bool> trace_enabled{false};
+    std::atomic<TraceBuffer*> trace_buffer{nullptr};
+    std::atomic<uint64_t> trace_next_request{0};
+    std::atomic<uint32_t> trace_next_thread{0};
+    thread_local uint64_t trace_current_request = 0;
+
+    // 写入方不持有任何锁，替换下来的缓冲区可能仍在写入，保留到进程退出；
+    // 容量不变时重新开启只移动 floor，不分配新的缓冲区
+    std::mutex trace_config_mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> trace_buffers;
+
+    const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+    uint32_t traceThreadId() {
+        thread_local uint32_t id = ++trace_next_thread;
+        return id;
+    }
+
+    int processId() {
+#if _WIN32
+        return _getpid();
+#else
+        return (int)getpid();
+#endif
+    }
+}
+
+void setTracing(bool enabled, size_t capacity) {
+    std::lock_guard<std::mutex> lock(trace_config_mutex);
+    if (enabled) {
+        // 每次开启都丢弃之前的记录
+        capacity = capacity > 0 ? capacity : 1;
+        TraceBuffer* buffer = trace_buffer.load(std::memory_order_relaxed);
+        if (buffer != nullptr && buffer->slots.size() == capacity) {
+            buffer->floor.store(buffer->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        } else {
+            trace_buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(capacity)));
+            trace_buffer.store(trace_buffers.back().get(), std::memory_order_release);
+        }
+    }
+    trace_enabled.store(enabled, std::memory_order_release);
+}
+
+bool tracingEnabled() {
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t currentTraceRequest() {
+    return trace_current_request;
+}
+
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+void recordSpan(uint64_t request, const char* name, int64_t begin, int64_t end, int64_t count) {
+    TraceBuffer* buffer = trace_buffer.load(std::memory_order_acquire);
+    if (request == 0 || buffer == nullptr || !tracingEnabled()) {
+        return;
+    }
+
+    uint64_t ticket = buffer->head.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot& slot = buffer->slots[ticket % buffer->slots.size()];
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.request.store(request, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.thread.store(traceThreadId(), std::memory_order_relaxed);
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+std::string traceJson() {
+    TraceBuffer* buffer = trace_buffer.load(std::memory_order_acquire);
+    int pid = processId();
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char event[384];
+    size_t capacity = buffer == nullptr ? 0 : buffer->slots.size();
+    uint64_t floor = buffer == nullptr ? 0 : buffer->floor.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < capacity; ++i) {
+        TraceSlot& slot = buffer->slots[i];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == 0 || (sequence & 1) != 0 || sequence / 2 - 1 < floor) {
+            continue;
+        }
+        const char* name = slot.name.load(std::memory_order_relaxed);
+        uint64_t request = slot.request.load(std::memory_order_relaxed);
+        int64_t begin = slot.begin.load(std::memory_order_relaxed);
+        int64_t end = slot.end.load(std::memory_order_relaxed);
+        int64_t count = slot.count.load(std::memory_order_relaxed);
+        uint32_t thread = slot.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;   // 读取期间被覆盖
+        }
+
+        // 每个请求一条轨道（tid 为请求编号），实际执行线程放在 args 中
+        int length = std::snprintf(event, sizeof(event),
+                                   "%s{\"name\":\"%s\",\"cat\":\"bergamot\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,"
+                                   "\"pid\":%d,\"tid\":%llu,\"args\":{\"thread\":%u",
+                                   first ? "" : ",", name, (long long)begin, (long long)(end - begin),
+                                   pid, (unsigned long long)request, thread);
+        json.append(event, (size_t)length);
+        if (count >= 0) {
+            length = std::snprintf(event, sizeof(event), ",\"count\":%lld", (long long)count);
+            json.append(event, (size_t)length);
+        }
+        json += "}}";
+        first = false;
+    }
+    json += "]}";
+    return json;
+}
+
+TraceRequest::TraceRequest(const char* name, int64_t count) : name_(name), count_(count) {
+    if (!tracingEnabled()) {
+        return;
+    }
+    request_ = ++trace_next_request;
+    previous_ = trace_current_request;
+    trace_current_request = request_;
+    begin_ = traceNow();
+}
+
+TraceRequest::~TraceRequest() {
+    if (request_ == 0) {
+        return;
+    }
+    recordSpan(request_, name_, begin_, traceNow(), count_);
+    trace_current_request = previous_;
+}
+
+TraceAdopt::TraceAdopt(uint64_t request) : previous_(trace_current_request) {
+    trace_current_request = request;
+}
+
+TraceAdopt::~TraceAdopt() {
+    trace_current_request = previous_;
+}
+
+TraceSpan::TraceSpan(const char* name, int64_t count) : name_(name), count_(count), request_(trace_current_request) {
+    if (request_ != 0) {
+        begin_ = traceNow();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (request_ != 0) {
+        recordSpan(request_, name_, begin_, traceNow(), count_);
+    }
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,81 @@
+#ifndef BERGAMOT_REQUEST_TRACE_H
+#define BERGAMOT_REQUEST_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 请求生命周期追踪
+//
+// 汇总统计说明不了单个慢请求卡在哪里。开启后每个 FFI 请求分配一个编号，其各阶段
+// （FFI 入口、缓存查找、排队等待、断句与子词编码、合并组批、解码、结果提取、输出拷贝）
+// 作为区间写入固定大小的无锁环形缓冲区，满后覆盖最旧的记录。
+// 导出为 Chrome/Perfetto 的 trace JSON：每个请求一条轨道，可直接在 ui.perfetto.dev 或
+// chrome://tracing 中打开。关闭时每个埋点只有一次原子读取。
+namespace bergamot_plugin {
+
+// capacity 为缓冲区可容纳的区间数；enabled 为 false 时停止记录（已有记录保留到下次开启）
+void setTracing(bool enabled, size_t capacity);
+bool tracingEnabled();
+
+// 当前线程所属请求的编号，0 表示不在追踪的请求中
+uint64_t currentTraceRequest();
+
+// 单调时钟的微秒数，用于显式记录起止时间
+int64_t traceNow();
+
+// 记录一个区间；name 必须是静态字符串。request 为 0 时不记录
+void recordSpan(uint64_t request, const char* name, int64_t begin, int64_t end, int64_t count = -1);
+
+// 导出缓冲区中的全部区间（Chrome trace event 格式）
+std::string traceJson();
+
+// FFI 入口：分配请求编号并绑定到当前线程，结束时记录整个调用的区间
+class TraceRequest {
+public:
+    TraceRequest(const char* name, int64_t count);
+    ~TraceRequest();
+
+    TraceRequest(const TraceRequest&) = delete;
+    TraceRequest& operator=(const TraceRequest&) = delete;
+
+private:
+    const char* name_;
+    int64_t count_;
+    uint64_t request_ = 0;
+    uint64_t previous_ = 0;
+    int64_t begin_ = 0;
+};
+
+// 在其他线程上继续某个请求（线程池任务、并行子请求）
+class TraceAdopt {
+public:
+    explicit TraceAdopt(uint64_t request);
+    ~TraceAdopt();
+
+    TraceAdopt(const TraceAdopt&) = delete;
+    TraceAdopt& operator=(const TraceAdopt&) = delete;
+
+private:
+    uint64_t previous_;
+};
+
+// 当前请求中的一个阶段
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, int64_t count = -1);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int64_t count_;
+    uint64_t request_;
+    int64_t begin_ = 0;
+};
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_REQUEST_TRACE_H
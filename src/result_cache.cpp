@@ -0,0 +1,145 @@
+#include "result_cache.h"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "fnv_hash.h"
+
+namespace bergamot_plugin {
+
+namespace {
+    // 分片降低线程池模式下的锁竞争
+    constexpr size_t kResultShardCount = 16;
+
+    struct ResultEntry {
+        uint64_t hash;
+        uint64_t model;
+        std::string text;
+        std::string translation;
+    };
+
+    struct ResultShard {
+        std::mutex mutex;
+        std::list<ResultEntry> lru;   // 头部为最近使用
+        std::unordered_map<uint64_t, std::list<ResultEntry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    ResultShard result_shards[kResultShardCount];
+    std::atomic<size_t> result_shard_capacity{0};
+    std::atomic<uint64_t> result_hits{0};
+    std::atomic<uint64_t> result_misses{0};
+
+    uint64_t hashKey(uint64_t model, const std::string& text) {
+        return fnv1a64(text.data(), text.size(), fnv1a64(&model, sizeof(model)));
+    }
+
+    // 链表节点、哈希表节点与两个字符串的估算占用
+    size_t entryBytes(const ResultEntry& entry) {
+        return sizeof(ResultEntry) + 6 * sizeof(void*) + entry.text.capacity() + entry.translation.capacity();
+    }
+
+    ResultShard& shardFor(uint64_t hash) {
+        return result_shards[hash % kResultShardCount];
+    }
+
+    void evict(ResultShard& shard, size_t capacity) {
+        while (shard.lru.size() > capacity) {
+            shard.bytes -= entryBytes(shard.lru.back());
+            shard.index.erase(shard.lru.back().hash);
+            shard.lru.pop_back();
+        }
+    }
+}
+
+void setResultCacheCapacity(size_t entries) {
+    size_t perShard = entries == 0 ? 0 : (entries + kResultShardCount - 1) / kResultShardCount;
+    result_shard_capacity.store(perShard);
+    for (auto& shard : result_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evict(shard, perShard);
+    }
+}
+
+bool resultCacheEnabled() {
+    return result_shard_capacity.load(std::memory_order_relaxed) > 0;
+}
+
+bool lookupResult(uint64_t model, const std::string& text, std::string& translation) {
+    uint64_t hash = hashKey(model, text);
+    ResultShard& shard = shardFor(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(hash);
+        if (it != shard.index.end() && it->second->model == model && it->second->text == text) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            translation = it->second->translation;
+            result_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    result_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void storeResult(uint64_t model, const std::string& text, const std::string& translation) {
+    size_t capacity = result_shard_capacity.load(std::memory_order_relaxed);
+    if (capacity == 0) {
+        return;
+    }
+
+    uint64_t hash = hashKey(model, text);
+    ResultShard& shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(hash);
+    if (it != shard.index.end()) {
+        // 相同内容或哈希冲突：都以新结果覆盖
+        shard.bytes -= entryBytes(*it->second);
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+    shard.lru.push_front(ResultEntry{hash, model, text, translation});
+    shard.index[hash] = shard.lru.begin();
+    shard.bytes += entryBytes(shard.lru.front());
+    evict(shard, capacity);
+}
+
+void trimResultCache(size_t entries) {
+    size_t perShard = (entries + kResultShardCount - 1) / kResultShardCount;
+    for (auto& shard : result_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evict(shard, perShard);
+        if (shard.lru.empty()) {
+            // 释放哈希表的桶数组
+            decltype(shard.index)().swap(shard.index);
+        }
+    }
+}
+
+ResultCacheStats resultCacheStats() {
+    ResultCacheStats stats;
+    stats.hits = result_hits.load();
+    stats.misses = result_misses.load();
+    stats.capacity = result_shard_capacity.load() * kResultShardCount;
+    for (auto& shard : result_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+void clearResultCache() {
+    for (auto& shard : result_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+    result_hits.store(0);
+    result_misses.store(0);
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,43 @@
+#ifndef BERGAMOT_RESULT_CACHE_H
+#define BERGAMOT_RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 输入文本级的译文缓存
+//
+// bergamot 自带的缓存按句子查找，命中前仍要先做断句与子词编码；并且以模型实例 id 为键，
+// 每个服务副本各有一份，重新加载同一模型后全部失效。这里在进入 bergamot 之前按
+// (模型内容标识, 输入文本) 查找，命中时完全跳过预处理与解码，并由所有副本、所有加载
+// 同一模型内容的缓存键共享。默认关闭。
+// 只保存完整译文，不保存断句与子词编码结果：分词在 bergamot 的 TranslationModel 内部完成，
+// 其接口不接受预先编码的输入，未命中时仍需完整预处理。
+namespace bergamot_plugin {
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t entries = 0;
+    size_t capacity = 0;
+    size_t bytes = 0;       // 条目占用的内存（文本、译文及节点开销的估算）
+};
+
+// 设置容量（条目数），0 关闭并清空缓存
+void setResultCacheCapacity(size_t entries);
+
+bool resultCacheEnabled();
+
+// model 为模型内容标识（见 ModelEntry::identity）
+bool lookupResult(uint64_t model, const std::string& text, std::string& translation);
+void storeResult(uint64_t model, const std::string& text, const std::string& translation);
+
+// 只保留最近使用的约 entries 条，容量不变（之后按需重新填满）
+void trimResultCache(size_t entries);
+
+ResultCacheStats resultCacheStats();
+void clearResultCache();
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_RESULT_CACHE_H
@@ -0,0 +1,207 @@
+#include "translation_session.h"
+
+#include <stdexcept>
+
+namespace bergamot_plugin {
+
+namespace {
+    bool isGapChar(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    bool isAsciiUpper(char c) {
+        return c >= 'A' && c <= 'Z';
+    }
+
+    bool isAsciiLower(char c) {
+        return c >= 'a' && c <= 'z';
+    }
+
+    // 全角句末标点 。！？ 的 UTF-8 长度，不是时返回 0
+    size_t wideTerminator(const std::string& s, size_t pos) {
+        if (pos + 3 > s.size()) {
+            return 0;
+        }
+        const unsigned char* p = (const unsigned char*)s.data() + pos;
+        if ((p[0] == 0xE3 && p[1] == 0x80 && p[2] == 0x82) ||
+            (p[0] == 0xEF && p[1] == 0xBC && (p[2] == 0x81 || p[2] == 0x9F))) {
+            return 3;
+        }
+        return 0;
+    }
+
+    // 紧跟在句末标点之后、仍属于本句的闭合引号或括号的长度
+    size_t closingMark(const std::string& s, size_t pos) {
+        if (pos >= s.size()) {
+            return 0;
+        }
+        char c = s[pos];
+        if (c == '"' || c == '\'' || c == ')' || c == ']') {
+            return 1;
+        }
+        if (pos + 3 > s.size()) {
+            return 0;
+        }
+        const unsigned char* p = (const unsigned char*)s.data() + pos;
+        // ” ’ 」 』 ）
+        if ((p[0] == 0xE2 && p[1] == 0x80 && (p[2] == 0x9D || p[2] == 0x99)) ||
+            (p[0] == 0xE3 && p[1] == 0x80 && (p[2] == 0x8D || p[2] == 0x8F)) ||
+            (p[0] == 0xEF && p[1] == 0xBC && p[2] == 0x89)) {
+            return 3;
+        }
+        return 0;
+    }
+
+    // "Dr. Smith"、"J. Smith"、"e.g. this" 这类位置不切分
+    bool looksLikeAbbreviation(const std::string& s, size_t dot, size_t next) {
+        if (next < s.size() && isAsciiLower(s[next])) {
+            return true;
+        }
+        size_t begin = dot;
+        while (begin > 0 && !isGapChar(s[begin - 1])) {
+            --begin;
+        }
+        std::string word = s.substr(begin, dot - begin);
+        if (word.size() == 1 && isAsciiUpper(word[0])) {
+            return true;
+        }
+        static const char* const kTitles[] = {"Mr", "Mrs", "Ms", "Dr", "Prof", "St", "Jr", "Sr", "vs", "etc", "No"};
+        for (const char* title : kTitles) {
+            if (word == title) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 从 pos 起找句子结束位置（不含之后的空白）
+    size_t sentenceEnd(const std::string& s, size_t pos) {
+        while (pos < s.size()) {
+            char c = s[pos];
+            if (c == '\n') {
+                return pos;
+            }
+            size_t wide = wideTerminator(s, pos);
+            if (wide > 0) {
+                size_t end = pos + wide;
+                while (size_t mark = closingMark(s, end)) {
+                    end += mark;
+                }
+                return end;
+            }
+            if (c == '.' || c == '!' || c == '?') {
+                size_t end = pos + 1;
+                while (end < s.size() && (s[end] == '.' || s[end] == '!' || s[end] == '?')) {
+                    ++end;
+                }
+                while (size_t mark = closingMark(s, end)) {
+                    end += mark;
+                }
+                if (end == s.size()) {
+                    return end;
+                }
+                if (isGapChar(s[end])) {
+                    size_t next = end;
+                    while (next < s.size() && isGapChar(s[next])) {
+                        ++next;
+                    }
+                    if (c != '.' || !looksLikeAbbreviation(s, pos, next)) {
+                        return end;
+                    }
+                }
+                pos = end;
+                continue;
+            }
+            ++pos;
+        }
+        return pos;
+    }
+}
+
+std::vector<SentencePiece> splitSentences(const std::string& text, std::string& trailing) {
+    std::vector<SentencePiece> pieces;
+    size_t pos = 0;
+    while (true) {
+        size_t begin = pos;
+        while (pos < text.size() && isGapChar(text[pos])) {
+            ++pos;
+        }
+        if (pos == text.size()) {
+            trailing = text.substr(begin);
+            return pieces;
+        }
+        size_t end = sentenceEnd(text, pos);
+        // 去掉句子末尾的空白（换行前可能有空格）
+        size_t last = end;
+        while (last > pos && isGapChar(text[last - 1])) {
+            --last;
+        }
+        SentencePiece piece;
+        piece.gap = text.substr(begin, pos - begin);
+        piece.sentence = text.substr(pos, last - pos);
+        pieces.push_back(std::move(piece));
+        pos = last;
+    }
+}
+
+TranslationSession::TranslationSession(TranslateBatch translate) : translate_(std::move(translate)) {}
+
+std::string TranslationSession::update(const std::string& text, size_t& translated) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string trailing;
+    std::vector<SentencePiece> pieces = splitSentences(text, trailing);
+
+    std::unordered_map<std::string, std::string> current;
+    std::vector<std::string> changed;
+    for (const auto& piece : pieces) {
+        if (current.count(piece.sentence) > 0) {
+            continue;
+        }
+        auto it = translations_.find(piece.sentence);
+        if (it != translations_.end()) {
+            current.emplace(piece.sentence, std::move(it->second));
+            translations_.erase(it);
+        } else {
+            current.emplace(piece.sentence, std::string());
+            changed.push_back(piece.sentence);
+        }
+    }
+
+    translated = changed.size();
+    if (!changed.empty()) {
+        std::vector<std::string> inputs = changed;
+        std::vector<std::string> outputs;
+        try {
+            outputs = translate_(std::move(inputs));
+            if (outputs.size() != changed.size()) {
+                throw std::runtime_error("Translation count does not match input");
+            }
+        } catch (...) {
+            // 保留已有译文，下次提交时仍可复用
+            for (auto& entry : current) {
+                if (!entry.second.empty()) {
+                    translations_.emplace(entry.first, std::move(entry.second));
+                }
+            }
+            throw;
+        }
+        for (size_t i = 0; i < changed.size(); ++i) {
+            current[changed[i]] = std::move(outputs[i]);
+        }
+    }
+
+    std::string result;
+    result.reserve(text.size());
+    for (const auto& piece : pieces) {
+        result += piece.gap;
+        result += current[piece.sentence];
+    }
+    result += trailing;
+
+    // 只保留当前版本的句子，内存随文档大小而不是编辑次数增长
+    translations_ = std::move(current);
+    return result;
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,42 @@
+#ifndef BERGAMOT_TRANSLATION_SESSION_H
+#define BERGAMOT_TRANSLATION_SESSION_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "file_pipeline.h"
+
+// 增量翻译会话
+//
+// 编辑器每次修改都提交整篇文本。会话按句子切分新版本，与上一版本的句子逐一比对，
+// 只把新增或改动的句子交给解码器，其余句子沿用上一版本的译文，再按原文的间隔拼接。
+// 因此边输入边翻译的延迟只取决于改动的句子，而不是文档长度。
+namespace bergamot_plugin {
+
+struct SentencePiece {
+    std::string gap;        // 句子之前的空白（含换行），原样保留
+    std::string sentence;
+};
+
+// 按句末标点（. ! ? 及全角 。！？）与换行切分，尽量避开缩写；trailing 为末尾空白
+std::vector<SentencePiece> splitSentences(const std::string& text, std::string& trailing);
+
+class TranslationSession {
+public:
+    explicit TranslationSession(TranslateBatch translate);
+
+    // 提交新版本，返回整篇译文；translated 为本次实际解码的句子数
+    std::string update(const std::string& text, size_t& translated);
+
+private:
+    TranslateBatch translate_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::string> translations_;   // 上一版本的句子 -> 译文
+};
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_TRANSLATION_SESSION_H
@@ -0,0 +1,105 @@
+#include "weight_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "common/io.h"
+#include "translator/byte_array_util.h"
+
+#include "cpu_features.h"
+#include "fnv_hash.h"
+
+using namespace marian::bergamot;
+
+namespace bergamot_plugin {
+
+namespace {
+    std::mutex weight_cache_mutex;
+    bool weight_cache_enabled = false;
+    std::string weight_cache_dir;
+
+    // 指纹覆盖整个模型：同一结构的不同微调版本可能只有中间的参数不同，
+    // 抽样会让它们共用缓存而静默加载错误的权重。模型已在内存中，哈希的开销远小于重排
+    uint64_t modelFingerprint(const AlignedMemory& model) {
+        uint64_t size = model.size();
+        return fnv1a64(model.begin(), model.size(), fnv1a64(&size, sizeof(size)));
+    }
+
+    std::string cachePathFor(const std::string& modelPath, const std::string& dir, uint64_t fingerprint) {
+        size_t slash = modelPath.find_last_of("/\\");
+        std::string modelDir = slash == std::string::npos ? "." : modelPath.substr(0, slash);
+        std::string base = slash == std::string::npos ? modelPath : modelPath.substr(slash + 1);
+        if (base.size() > 4 && base.compare(base.size() - 4, 4, ".bin") == 0) {
+            base.resize(base.size() - 4);
+        }
+
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)fingerprint);
+
+        // marian::io::saveItems 依据 .bin 后缀选择二进制格式
+        return (dir.empty() ? modelDir : dir) + "/" + base + "." + intgemmIsaName() + "." + hex + ".prepared.bin";
+    }
+
+    bool fileExists(const std::string& path) {
+        std::ifstream f(path, std::ios::binary);
+        return f.good();
+    }
+
+    void writeCache(const AlignedMemory& model, const std::string& cachePath) {
+        // loadItems 会把通用 intgemm8 矩阵按当前指令集重排，并把类型改成指令集专用类型
+        std::vector<marian::io::Item> items = marian::io::loadItems(model.begin());
+
+        // 先写临时文件再重命名，避免并发加载读到半个文件
+        auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        std::string tmpPath = cachePath + "." + std::to_string(stamp) + ".tmp.bin";
+        marian::io::saveItems(tmpPath, items);
+        if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            throw std::runtime_error("cannot rename " + tmpPath);
+        }
+    }
+}
+
+void setWeightCache(bool enabled, const std::string& cacheDir) {
+    std::lock_guard<std::mutex> lock(weight_cache_mutex);
+    weight_cache_enabled = enabled;
+    weight_cache_dir = cacheDir;
+}
+
+bool weightCacheEnabled() {
+    std::lock_guard<std::mutex> lock(weight_cache_mutex);
+    return weight_cache_enabled;
+}
+
+AlignedMemory preparedModelMemory(const std::string& modelPath, AlignedMemory&& model) {
+#ifdef USE_INTGEMM
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(weight_cache_mutex);
+        if (!weight_cache_enabled) {
+            return std::move(model);
+        }
+        dir = weight_cache_dir;
+    }
+
+    std::string cachePath = cachePathFor(modelPath, dir, modelFingerprint(model));
+    try {
+        if (!fileExists(cachePath)) {
+            writeCache(model, cachePath);
+        }
+        // 刚写出的缓存同样直接读回，marian 不必再重排一次
+        return loadFileToMemory(cachePath, 256);
+    } catch (const std::exception& e) {
+        std::cerr << "[weight_cache] Warning: " << cachePath << ": " << e.what() << std::endl;
+    }
+#else
+    (void)modelPath;
+#endif
+    return std::move(model);
+}
+
+} // namespace bergamot_plugin
@@ -0,0 +1,30 @@
+#ifndef BERGAMOT_WEIGHT_CACHE_H
+#define BERGAMOT_WEIGHT_CACHE_H
+
+#include <string>
+
+#include "translator/definitions.h"
+
+// 预处理权重缓存
+//
+// *.intgemm.alphas.bin 中的 int8 权重只做了量化，加载时 marian 还要按运行时检测到的
+// 指令集（SSSE3/AVX2/AVX512BW/AVX512VNNI）做 PrepareB 重排（见 prepareAndTransposeB）。
+// 这里把重排后的权重连同指令集专用类型（如 intgemm8avx2）另存为 .bin，
+// 之后加载时 marian 识别到指令集专用类型，直接拷贝而不再重排。
+//
+// 缓存文件名包含模型内容的哈希与指令集，模型更新或换到不同 CPU 时自动失效。
+namespace bergamot_plugin {
+
+// 启用/禁用缓存。cacheDir 为空时缓存文件写在模型文件旁边。
+void setWeightCache(bool enabled, const std::string& cacheDir);
+bool weightCacheEnabled();
+
+// 若存在与 model 匹配的缓存则返回缓存内容，否则写出缓存后返回重排好的缓存内容；
+// 缓存出错时原样返回 model。
+// modelPath 用于确定缓存文件名及默认目录。任何缓存错误都只记录日志，不影响加载。
+marian::bergamot::AlignedMemory preparedModelMemory(const std::string& modelPath,
+                                                    marian::bergamot::AlignedMemory&& model);
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_WEIGHT_CACHE_H
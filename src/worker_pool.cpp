@@ -0,0 +1,175 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+namespace bergamot_plugin {
+
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? list.size() : comma + 1;
+
+        // 去掉首尾空白（sysfs 的 cpulist 以换行结尾）
+        size_t begin = item.find_first_not_of(" \t\n");
+        size_t end = item.find_last_not_of(" \t\n");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        item = item.substr(begin, end - begin + 1);
+
+        char* rest = nullptr;
+        long first = std::strtol(item.c_str(), &rest, 10);
+        long last = first;
+        if (*rest == '-') {
+            last = std::strtol(rest + 1, &rest, 10);
+        }
+        if (*rest != '\0' || first < 0 || last < first) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back((int)cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int>> numaNodeCpus() {
+    std::vector<std::vector<int>> nodes;
+#if defined(__linux__)
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == nullptr) {
+        return nodes;
+    }
+
+    std::vector<int> ids;
+    while (struct dirent* entry = readdir(dir)) {
+        int id;
+        char trailing;
+        if (std::sscanf(entry->d_name, "node%d%c", &id, &trailing) == 1) {
+            ids.push_back(id);
+        }
+    }
+    closedir(dir);
+
+    std::sort(ids.begin(), ids.end());
+    for (int id : ids) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string list;
+        std::getline(in, list);
+        try {
+            std::vector<int> cpus = parseCpuList(list);
+            if (!cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        } catch (const std::invalid_argument&) {
+            // 忽略无法解析的节点
+        }
+    }
+#endif
+    return nodes;
+}
+
+int currentCpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+ScopedAffinity::ScopedAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    if (cpus.empty()) {
+        return;
+    }
+
+    cpu_set_t saved;
+    CPU_ZERO(&saved);
+    if (sched_getaffinity(0, sizeof(saved), &saved) != 0) {
+        return;
+    }
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &mask);
+        }
+    }
+    // pid 0 表示调用线程
+    if (sched_setaffinity(0, sizeof(mask), &mask) == 0) {
+        saved_.assign(reinterpret_cast<unsigned char*>(&saved),
+                      reinterpret_cast<unsigned char*>(&saved) + sizeof(saved));
+        applied_ = true;
+    }
+#else
+    (void)cpus;
+#endif
+}
+
+ScopedAffinity::~ScopedAffinity() {
+#if defined(__linux__)
+    if (applied_) {
+        cpu_set_t saved;
+        std::memcpy(&saved, saved_.data(), sizeof(saved));
+        sched_setaffinity(0, sizeof(saved), &saved);
+    }
+#endif
+}
+
+TaskPool::TaskPool(size_t threads, size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { run(); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    notEmpty_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void TaskPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [this] { return queue_.size() < capacity_; });
+    queue_.push_back(std::move(task));
+    lock.unlock();
+    notEmpty_.notify_one();
+}
+
+void TaskPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        notFull_.notify_one();
+        task();
+    }
+}
+
+} // namespace bergamot_plugin
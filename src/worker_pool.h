@@ -0,0 +1,72 @@
+#ifndef BERGAMOT_WORKER_POOL_H
+#define BERGAMOT_WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 工作线程的 CPU 亲和性与 NUMA 拓扑工具
+//
+// bergamot 的 AsyncService 在构造函数中创建全部工作线程，不暴露线程句柄。
+// Linux 上新线程继承创建者的 CPU 亲和性掩码，因此在构造服务期间临时绑定调用线程
+// （ScopedAffinity），即可把该服务的全部工作线程限定在指定 CPU 集合上。
+// 其他平台不支持或不需要绑定，相关函数退化为空操作。
+namespace bergamot_plugin {
+
+// 解析 "0-7,16-23" 形式的 CPU 列表；格式错误时抛出 std::invalid_argument
+std::vector<int> parseCpuList(const std::string& list);
+
+// 每个 NUMA 节点的 CPU 列表；无法获取拓扑时返回空
+std::vector<std::vector<int>> numaNodeCpus();
+
+// 调用线程当前所在的 CPU，未知时返回 -1
+int currentCpu();
+
+class ScopedAffinity {
+public:
+    // cpus 为空时不做任何修改
+    explicit ScopedAffinity(const std::vector<int>& cpus);
+    ~ScopedAffinity();
+
+    ScopedAffinity(const ScopedAffinity&) = delete;
+    ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+
+private:
+    bool applied_ = false;
+#if defined(__linux__)
+    std::vector<unsigned char> saved_;
+#endif
+};
+
+// 固定线程数的任务池，任务队列有上限
+// submit 在队列满时阻塞，从而对提交方形成背压；析构时先执行完已提交的任务再退出
+// 任务不应抛出异常
+class TaskPool {
+public:
+    TaskPool(size_t threads, size_t capacity);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+private:
+    void run();
+
+    size_t capacity_;
+    bool stopping_ = false;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace bergamot_plugin
+
+#endif // BERGAMOT_WORKER_POOL_H
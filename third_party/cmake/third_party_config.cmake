@@ -174,6 +174,31 @@ if(APPLE AND NOT IOS AND CMAKE_OSX_ARCHITECTURES MATCHES "arm64")
     message(STATUS "Adding global ARM FMA SSE compile definitions for macOS ARM64 platform")
 endif()
 
+# Portable x86-64 desktop builds (Linux/Windows/macOS Intel)
+# marian-dev defaults to BUILD_ARCH=native with AUTO_CPU_DETECT, which bakes the build host's
+# AVX2/AVX512 flags into every object: the binary then either crashes on older hosts or misses
+# faster kernels on newer ones. Instead compile everything for a common baseline (x86-64 + SSE4.1,
+# which marian's SSE code paths need) and rely on runtime dispatch for the hot GEMMs:
+#   - intgemm builds SSSE3/AVX2/AVX512BW/AVX512VNNI kernels with per-function target attributes
+#     and picks one from CPUID at startup (override with INTGEMM_CPUID=<ISA>)
+#   - ruy (USE_RUY_SGEMM) selects its AVX2/AVX512 float kernels at runtime via cpuinfo
+# The chosen path is reported by bergamot_get_cpu_info().
+option(BERGAMOT_PORTABLE_BUILD "Build x86-64 binaries for a generic baseline and dispatch GEMM kernels at runtime" ON)
+if(BERGAMOT_PORTABLE_BUILD AND NOT ANDROID AND NOT IOS
+   AND NOT (APPLE AND CMAKE_OSX_ARCHITECTURES MATCHES "arm64")
+   AND CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$")
+    set(BUILD_ARCH "x86-64" CACHE STRING "Build architecture" FORCE)
+    set(AUTO_CPU_DETECT OFF CACHE BOOL "Disable CPU feature detection" FORCE)
+    if(MSVC)
+        # MSVC has no SSE4.1 switch for x64: SSE4.1 intrinsics are always available and the next
+        # /arch level (/arch:AVX) would raise the baseline, so keep the default /arch:SSE2
+        message(STATUS "Portable x86-64 build: BUILD_ARCH=x86-64 /arch:SSE2, GEMM kernels dispatched at runtime")
+    else()
+        add_compile_options(-msse4.1)
+        message(STATUS "Portable x86-64 build: BUILD_ARCH=x86-64 -msse4.1, GEMM kernels dispatched at runtime")
+    endif()
+endif()
+
 # Suppress CMake warnings from third-party libraries
 # Set policy to suppress exec_program deprecation warning (CMP0153)
 # This is needed because FindSSE.cmake uses exec_program